@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ClientSlots.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Benchmark of sweeps over all clients, which look for the few Ready and
+ * 	flagged ones: walking whole Client instances (as before ClientTable)
+ * 	against the dense table and the queue of Ready clients.
+ *
+ * 		bench_client_table [clients]
+ *
+ */
+
+
+/** Clients connected, when no count is given. */
+constexpr const int CLIENTS = 100000;
+/** Clients, who are Ready and flagged (spread over slots). */
+constexpr const int FEW = 3;
+/** Repetitions of one timed sweep. */
+constexpr const int ROUNDS = 200;
+
+
+/** Average time of one call of given function in microseconds. */
+template<typename F>
+static double timeIt(F f) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ROUNDS; ++i) {
+        f();
+    }
+
+    std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - start;
+
+    return took.count() / ROUNDS;
+}
+
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : CLIENTS;
+    std::vector<Client> instances;
+    ClientSlots slots;
+    volatile int found = 0;
+
+    if (count < FEW) {
+        std::printf("count of clients has to be at least %d\n", FEW);
+        return 1;
+    }
+
+    instances.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        instances.emplace_back(0x0100007f, i + 10);
+        slots.emplace(0x0100007f, i + 10);
+    }
+
+    // few clients in the middle of sweep are Ready and few flagged
+    for (int i = 1; i <= FEW; ++i) {
+        int slot = count / (FEW + 1) * i;
+
+        instances[slot].setState(Ready);
+        slots.at(slot)->setState(Ready);
+        instances[slot + 1].setFlagToErase(true);
+        slots.at(slot + 1)->setFlagToErase(true);
+    }
+
+    double readyBefore = timeIt([&] {
+        for (const Client& client : instances) {
+            if (client.getState() == Ready) {
+                found = found + 1;
+            }
+        }
+    });
+    double readyAfter = timeIt([&] {
+        for (auto client = slots.firstReady(0); client != slots.end(); client = slots.nextReady(client)) {
+            found = found + 1;
+        }
+    });
+    double flagsBefore = timeIt([&] {
+        for (const Client& client : instances) {
+            if (client.getFlagToDisconnect() || client.getFlagToErase()) {
+                found = found + 1;
+            }
+        }
+    });
+    double flagsAfter = timeIt([&] {
+        for (auto client = slots.findFlagged(slots.begin()); client != slots.end(); client = slots.findFlagged(++client)) {
+            found = found + 1;
+        }
+    });
+
+    std::printf("%d clients (%d Ready, %d flagged), sizeof(Client) %zu B [us]\n", count, FEW, FEW, sizeof(Client));
+    std::printf("%-12s %12s %12s\n", "", "instances", "table");
+    std::printf("%-12s %12.2f %12.2f\n", "ready scan", readyBefore, readyAfter);
+    std::printf("%-12s %12.2f %12.2f\n", "flag scan", flagsBefore, flagsAfter);
+
+    return 0;
+}
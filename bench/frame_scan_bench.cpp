@@ -0,0 +1,263 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "frame_scan.hpp"
+#include "RingBuffer.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Benchmark of taking frames from receive ring and of stripSkipped()
+ * 	kernels, with check of kernels against the scalar one.
+ *
+ * 		bench_frame_scan            time kernels and takeFrames()
+ * 		bench_frame_scan --check    compare kernels, exit 1 on difference
+ *
+ */
+
+
+/** Size of receive ring, same as RingBuffer::CAPACITY. */
+constexpr const unsigned RING = 1024;
+/** Chat frame with 100 characters of message. */
+constexpr const int MESSAGE = 100;
+/** Lengths, which are checked exhaustively (two AVX2 blocks). */
+constexpr const int CHECKED = 64;
+/** Repetitions of one timed operation. */
+constexpr const int ROUNDS = 200000;
+
+
+/******************************************************************************
+ *
+ * 	Receive ring before frame_scan, which took frames byte by byte
+ * 	through masking accessor. Kept here as baseline.
+ *
+ */
+class ByteLoopRing {
+private:
+    std::vector<char> data;
+    unsigned head;
+    unsigned tail;
+
+    char at(const unsigned& position) const {
+        return this->data[position & (RING - 1)];
+    }
+
+    static bool isSkipped(const char& c) {
+        return c == '\n' || c == '\r' || c == '\0';
+    }
+
+public:
+    ByteLoopRing() {
+        this->data = std::vector<char>(RING);
+        this->head = 0;
+        this->tail = 0;
+    }
+
+    void write(const char* src, const int& len) {
+        for (int i = 0; i < len; ++i) {
+            this->data[(this->head + i) & (RING - 1)] = src[i];
+        }
+        this->head += len;
+    }
+
+    void takeFrames(std::string& frames) {
+        unsigned end = this->head;
+        char c = '\0';
+
+        frames.clear();
+
+        while (end != this->tail && this->at(end - 1) != '}') {
+            --end;
+        }
+
+        while (end != this->head && isSkipped(this->at(end))) {
+            ++end;
+        }
+
+        for (; this->tail != end; ++this->tail) {
+            c = this->at(this->tail);
+
+            if (!isSkipped(c)) {
+                frames += c;
+            }
+        }
+    }
+};
+
+
+/** As many chat frames as fit to ring, each optionally followed by newline. */
+static std::string chatFrames(const bool& newlines) {
+    std::string frame = "{ch:" + std::string(MESSAGE, 'x') + "}" + (newlines ? "\n" : "");
+    std::string frames;
+
+    while (frames.size() + frame.size() <= RING) {
+        frames += frame;
+    }
+
+    return frames;
+}
+
+
+/** Average time of one call of given function in microseconds. */
+template<typename F>
+static double timeIt(F f) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ROUNDS; ++i) {
+        f();
+    }
+
+    std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - start;
+
+    return took.count() / ROUNDS;
+}
+
+
+static void benchmark() {
+    std::string taken;
+    taken.reserve(RING);
+
+    const std::pair<const char*, std::string> inputs[] = {
+        {"with newlines", chatFrames(true)},
+        {"without", chatFrames(false)},
+        // the most common message, ring is drained after each one
+        {"one pong", "{<}"},
+    };
+
+    std::printf("picked kernel: %s\n\n", getScanKernel());
+    std::printf("takeFrames() of ring full of %d-character chat frames, and of one pong [us]\n", MESSAGE);
+    std::printf("%-16s %12s %12s\n", "", "byte loop", "frame_scan");
+
+    for (const auto& [name, frames] : inputs) {
+        ByteLoopRing old;
+        RingBuffer ring;
+
+        double before = timeIt([&] {
+            old.write(frames.data(), frames.size());
+            old.takeFrames(taken);
+        });
+        double after = timeIt([&] {
+            ring.write(frames.data(), frames.size());
+            ring.takeFrames(taken);
+        });
+
+        std::printf("%-16s %12.3f %12.3f\n", name, before, after);
+    }
+
+    std::printf("\nstripSkipped() of the same frames [us]\n");
+    std::printf("%-16s %12s %12s\n", "", "with newlines", "without");
+
+    for (const auto& [name, strip] : getScanKernels()) {
+        double times[2];
+        int i = 0;
+
+        for (bool newlines : {true, false}) {
+            std::string frames = chatFrames(newlines);
+            std::vector<char> dst(frames.size());
+
+            times[i++] = timeIt([&] {
+                strip(frames.data(), frames.size(), dst.data());
+                // keep compiler from dropping the call
+                asm volatile("" : : "r"(dst.data()) : "memory");
+            });
+        }
+
+        std::printf("%-16s %12.3f %12.3f\n", name, times[0], times[1]);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Every kernel has to give the same bytes as the scalar one, both to
+ * 	other buffer and compacting in place, for every length up to two AVX2
+ * 	blocks: with one skipped byte on every position, with every byte
+ * 	skipped and with random mixes of skipped and plain bytes.
+ *
+ */
+static bool compare(const char* name, const ScanKernel& strip, const ScanKernel& reference, const std::string& src) {
+    std::string expected(src.size(), '\0');
+    std::string separate(src.size(), '\0');
+    std::string inPlace = src;
+    std::size_t expectedLength = reference(src.data(), src.size(), &expected[0]);
+    std::size_t separateLength = strip(src.data(), src.size(), &separate[0]);
+    std::size_t inPlaceLength = strip(inPlace.data(), inPlace.size(), &inPlace[0]);
+
+    expected.resize(expectedLength);
+    separate.resize(separateLength);
+    inPlace.resize(inPlaceLength);
+
+    if (separate != expected || inPlace != expected) {
+        std::printf("%s differs from scalar for length %zu\n", name, src.size());
+        return false;
+    }
+
+    return true;
+}
+
+
+static int check() {
+    const char skipped[] = {'\n', '\r', '\0'};
+    std::vector<std::pair<const char*, ScanKernel>> kernels = getScanKernels();
+    const ScanKernel reference = kernels[0].second;
+    std::mt19937 random(42);
+    std::vector<std::string> inputs;
+    bool same = true;
+
+    for (int length = 0; length <= CHECKED; ++length) {
+        std::string plain(length, 'a');
+
+        for (int i = 0; i < length; ++i) {
+            plain[i] = (char) ('a' + i % 26);
+        }
+
+        inputs.push_back(plain);
+
+        for (char c : skipped) {
+            inputs.emplace_back(length, c);
+
+            for (int position = 0; position < length; ++position) {
+                inputs.push_back(plain);
+                inputs.back()[position] = c;
+            }
+        }
+
+        for (int i = 0; i < 100; ++i) {
+            inputs.push_back(plain);
+
+            for (char& c : inputs.back()) {
+                if (random() % 4 == 0) {
+                    c = skipped[random() % 3];
+                }
+            }
+        }
+    }
+
+    for (const auto& [name, strip] : kernels) {
+        bool kernelSame = true;
+
+        for (const std::string& input : inputs) {
+            kernelSame = compare(name, strip, reference, input) && kernelSame;
+        }
+
+        std::printf("%-8s %zu inputs %s\n", name, inputs.size(), kernelSame ? "ok" : "FAILED");
+        same = same && kernelSame;
+    }
+
+    return same ? 0 : 1;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--check") == 0) {
+        return check();
+    }
+
+    benchmark();
+
+    return 0;
+}
@@ -0,0 +1,367 @@
+#!/usr/bin/env python3
+"""
+Load test of the server: memory per connection and move latency of players,
+while many idle clients are connected.
+
+For every given count of clients starts the server, connects idle clients,
+which log in and stay in lobby (answering pings only), and pairs players,
+who make up the rest of the count. Reports resident memory of the server
+per idle client and time from sending a move to the opponent receiving it.
+Players play the same four moves over and over, so games never end.
+
+    bench/loadtest.py --clients 10000
+    bench/loadtest.py --bin build/KIV_UPS_sp_server --clients 1000,10000,100000
+    bench/loadtest.py --clients 10000 -- -e uring -t 2
+
+Server is build/KIV_UPS_sp_server by default, as built by
+'cmake -S . -B build && cmake --build build'.
+
+Arguments after '--' are passed to the server.
+
+Idle clients are connected by worker processes, each from its own source
+address (127.0.0.2, 127.0.0.3, ...), so neither the limit of open files of
+one process nor ephemeral ports of one address stop the test. The server
+holds all connections in one process, so a count, which does not fit into
+the hard limit of open files (ulimit -Hn), is skipped.
+"""
+
+import argparse
+import multiprocessing
+import os
+import random
+import resource
+import selectors
+import shutil
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+# black and white move there and back again: (player, move)
+CYCLE = [(0, b'03000301'), (1, b'03050205'), (0, b'03010300'), (1, b'02050305')]
+# descriptors of a process besides sockets
+FILES_SLACK = 64
+# connections from one source address (ephemeral ports are 32768-60999 by default)
+PER_ADDRESS = 25000
+# most clients accepted by server (-c)
+MAX_CLIENTS = 100000
+# port is chosen on connect, so ports of one address are not used up by bind
+IP_BIND_ADDRESS_NO_PORT = 24
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Memory per connection and move latency of players with idle clients connected.')
+    parser.add_argument('--bin', default='build/KIV_UPS_sp_server', help='server executable')
+    parser.add_argument('--clients', default='10000', help='comma separated counts of connected clients (idle ones and players)')
+    parser.add_argument('--games', type=int, default=50, help='games of players, who move')
+    parser.add_argument('--rounds', type=int, default=20, help='moves of every game')
+    parser.add_argument('--port', type=int, default=0, help='port of server (0 == random)')
+    parser.add_argument('--backlog', type=int, default=4096, help='listen backlog of server (0 == server default)')
+    parser.add_argument('server_args', nargs='*', help='arguments of server (after --)')
+
+    args = parser.parse_args()
+
+    if not os.access(args.bin, os.X_OK):
+        parser.error('server executable %s not found, build it or give --bin' % args.bin)
+
+    args.clients = [int(count) for count in args.clients.split(',')]
+
+    return args
+
+
+def raise_files():
+    """Raise soft limit of open files up to hard one (server and workers inherit it), returns the limit."""
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+
+    if soft != hard:
+        resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+    return hard if hard != resource.RLIM_INFINITY else sys.maxsize
+
+
+def is_listening(port):
+    """Some socket listens on given port, looked up in /proc, so server gets no extra connection."""
+    with open('/proc/net/tcp') as sockets:
+        for line in sockets.readlines()[1:]:
+            fields = line.split()
+
+            if int(fields[1].split(':')[1], 16) == port and fields[3] == '0A':
+                return True
+
+    return False
+
+
+def resident_kb(pid):
+    """Resident memory of process in kB."""
+    with open('/proc/%d/status' % pid) as status:
+        for line in status:
+            if line.startswith('VmRSS:'):
+                return int(line.split()[1])
+
+    return 0
+
+
+def start_server(args, clients, rooms):
+    """Run server in temporary directory (it logs to ../log/), returns process and directory."""
+    work = tempfile.mkdtemp(prefix='loadtest-')
+    os.makedirs(os.path.join(work, 'bin'))
+    os.makedirs(os.path.join(work, 'log'))
+
+    cmd = [os.path.abspath(args.bin), '-p', str(args.port), '-c', str(clients), '-r', str(rooms)]
+
+    if args.backlog > 0:
+        cmd += ['-b', str(args.backlog)]
+
+    server = subprocess.Popen(cmd + args.server_args, cwd=os.path.join(work, 'bin'),
+                              stdout=subprocess.DEVNULL, stderr=subprocess.STDOUT)
+
+    for _ in range(100):
+        if server.poll() is None and is_listening(args.port):
+            break
+        time.sleep(0.05)
+    else:
+        server.kill()
+        sys.exit('server did not start')
+
+    return server, work
+
+
+def stop_server(server, work):
+    server.send_signal(signal.SIGINT)
+
+    try:
+        server.wait(60)
+    except subprocess.TimeoutExpired:
+        server.kill()
+        server.wait()
+
+    shutil.rmtree(work, ignore_errors=True)
+
+
+class Peer:
+    """Connection of one client with buffer of received, but not expected data."""
+
+    def __init__(self, sock):
+        self.sock = sock
+        self.data = b''
+
+    def receive(self):
+        """Read what is in socket, answer pings. Returns False on end of connection."""
+        try:
+            chunk = self.sock.recv(65536)
+        except BlockingIOError:
+            return True
+
+        if not chunk:
+            return False
+
+        self.data += chunk
+
+        # heartbeat, nobody waits for it
+        while b'{>}' in self.data:
+            self.data = self.data.replace(b'{>}', b'', 1)
+            self.sock.sendall(b'{<}')
+
+        return True
+
+    def expect(self, token, timeout=10.0):
+        """Wait for given token, drop everything up to its end. Returns data up to the token."""
+        deadline = time.monotonic() + timeout
+
+        while token not in self.data:
+            remaining = deadline - time.monotonic()
+
+            if remaining <= 0:
+                raise TimeoutError('%r not received, got %r' % (token, self.data[-80:]))
+
+            self.sock.settimeout(remaining)
+
+            try:
+                if not self.receive():
+                    raise ConnectionError('connection closed, waiting for %r' % token)
+            except socket.timeout:
+                pass
+
+        end = self.data.index(token) + len(token)
+        seen = self.data[:end]
+        self.data = self.data[end:]
+
+        return seen
+
+
+def connect(port, source='127.0.0.1'):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, 1)
+    sock.bind((source, 0))
+    sock.connect(('127.0.0.1', port))
+
+    return sock
+
+
+def idle_worker(port, source, first, count, ready, stop):
+    """Connect and log in idle clients (all requests are sent before replies are read), answer pings until stopped."""
+    selector = selectors.DefaultSelector()
+    peers = []
+
+    try:
+        for i in range(first, first + count):
+            sock = connect(port, source)
+            sock.sendall(b'{c:i%06d}' % i)
+            peers.append(Peer(sock))
+
+        for peer in peers:
+            peer.expect(b'{il}', 60.0)
+            peer.sock.setblocking(False)
+            selector.register(peer.sock, selectors.EVENT_READ, peer)
+    except (OSError, TimeoutError) as error:
+        ready.send(str(error))
+        return
+
+    ready.send(None)
+
+    while not stop.poll():
+        for key, _ in selector.select(0.1):
+            key.data.receive()
+
+
+def connect_idle(port, count, per_worker):
+    """Start workers with idle clients and wait for their logins, returns workers and pipe to stop them."""
+    stop_recv, stop_send = multiprocessing.Pipe(False)
+    workers = []
+    readies = []
+
+    for w, first in enumerate(range(0, count, per_worker)):
+        ready_recv, ready_send = multiprocessing.Pipe(False)
+        worker = multiprocessing.Process(target=idle_worker,
+                                         args=(port, '127.0.0.%d' % (2 + w), first, min(per_worker, count - first),
+                                               ready_send, stop_recv))
+        worker.start()
+        workers.append(worker)
+        readies.append(ready_recv)
+
+    for ready in readies:
+        error = ready.recv()
+
+        if error is not None:
+            stop_send.send(True)
+            raise ConnectionError('idle clients failed: %s' % error)
+
+    return workers, stop_send
+
+
+def connect_games(port, games):
+    """Log in and pair players, returns pairs (black, white)."""
+    pairs = []
+
+    for g in range(games):
+        pair = []
+
+        for side in range(2):
+            sock = connect(port)
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            peer = Peer(sock)
+
+            sock.sendall(b'{c:p%05d%d}' % (g, side))
+            peer.expect(b'{il}')
+            pair.append(peer)
+
+        # fifo matchmaking pairs them, who gets turn is black
+        for peer in pair:
+            peer.sock.sendall(b'{rd}')
+
+        started = [peer.expect(b'}') for peer in pair]
+
+        if b'{ig,ty' not in started[0]:
+            pair.reverse()
+
+        pairs.append(pair)
+
+    return pairs
+
+
+def measure_moves(pairs, rounds):
+    """Time from sending move to opponent receiving it, in microseconds."""
+    latencies = []
+
+    for step in range(rounds):
+        side, move = CYCLE[step % len(CYCLE)]
+
+        for pair in pairs:
+            mover, opponent = pair[side], pair[1 - side]
+
+            start = time.perf_counter()
+            mover.sock.sendall(b'{m:' + move + b'}')
+            opponent.expect(b'{om:' + move + b'}')
+            latencies.append((time.perf_counter() - start) * 1e6)
+
+            mover.expect(b'{mv}')
+
+    return sorted(latencies)
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p))]
+
+
+def run(args, clients, files):
+    """Measure server with given count of connected clients."""
+    idle = clients - 2 * args.games
+    port = args.port if args.port != 0 else random.randint(20000, 40000)
+
+    if idle < 0:
+        print('%d clients: skipped, fewer than %d players' % (clients, 2 * args.games))
+        return
+
+    if clients > MAX_CLIENTS or clients + FILES_SLACK > files:
+        print('%d clients: skipped, server takes at most %d and hard limit of open files is %d (see ulimit -Hn)'
+              % (clients, min(MAX_CLIENTS, files - FILES_SLACK), files))
+        return
+
+    args.port = port
+    server, work = start_server(args, min(clients + 16, MAX_CLIENTS), args.games + 16)
+    workers, stop = [], None
+
+    try:
+        empty = resident_kb(server.pid)
+
+        start = time.monotonic()
+        workers, stop = connect_idle(port, idle, min(files - FILES_SLACK, PER_ADDRESS))
+        connected = time.monotonic() - start
+        lobby = resident_kb(server.pid)
+
+        pairs = connect_games(port, args.games)
+        latencies = measure_moves(pairs, args.rounds)
+        playing = resident_kb(server.pid)
+
+        if server.poll() is not None:
+            sys.exit('server exited during test')
+
+        print('%d clients: %d idle connected and logged in %.2f s (%d workers)' % (clients, idle, connected, len(workers)))
+        print('  server RSS kB: empty %d, idle clients %d, games %d -> %.0f B per idle client, %.0f B per connection'
+              % (empty, lobby, playing, (lobby - empty) * 1024.0 / max(idle, 1), (playing - empty) * 1024.0 / clients))
+        print('  moves %d in %d games, latency us: p50 %.0f  p99 %.0f  max %.0f'
+              % (len(latencies), len(pairs), percentile(latencies, 0.5), percentile(latencies, 0.99), latencies[-1]))
+    finally:
+        if stop is not None:
+            stop.send(True)
+
+        for worker in workers:
+            worker.join(30)
+
+        stop_server(server, work)
+
+
+def main():
+    args = parse_args()
+    files = raise_files()
+    port = args.port
+
+    for clients in args.clients:
+        args.port = port
+        run(args, clients, files)
+
+
+if __name__ == '__main__':
+    main()
@@ -1,4 +1,5 @@
 #include "Lobby.hpp"
+#include "rating.hpp"
 #include "../system/Logger.hpp"
 
 // ---------- CONSTRUCTORS & DESTRUCTORS
@@ -9,7 +10,10 @@
 
 Lobby::Lobby() {
     this->games = std::vector<RoomHnefatafl>();
+    this->freeSlots = std::vector<int>();
+    this->occupied = std::vector<bool>();
     this->roomsTotal = 0;
+    this->maxRooms = 0;
 }
 
 
@@ -22,22 +26,44 @@ Lobby::Lobby() {
 
 
 
+void Lobby::rateGame(const int& id, Client& winner, Client& loser) {
+    int ratingWinner = winner.getRating();
+    int ratingLoser = loser.getRating();
 
+    updateRatings(ratingWinner, ratingLoser);
 
-// ----- GETTERS
+    winner.setRating(ratingWinner);
+    loser.setRating(ratingLoser);
 
+    logger->info("Room id [%d] rated, winner [%s] has [%d], loser [%s] has [%d].",
+                 id, winner.getNick().c_str(), ratingWinner, loser.getNick().c_str(), ratingLoser);
+}
 
-roomsIterator Lobby::getRoomById(const int& id) {
-    auto wanted = this->games.end();
 
-    for (auto itr = this->games.begin(); itr != this->games.end(); ++itr) {
-        if (itr->getRoomId() == id) {
-            wanted = itr;
-            break;
-        }
+void Lobby::moveToLobby(Client& client) {
+    State state = client.getState();
+
+    // set state of player to Waiting according to its connection/disconnection
+    if (state == Pinged || state == Lost || state == Disconnected) {
+        client.setStateLast(Waiting);
+    }
+    else {
+        client.setState(Waiting);
     }
 
-    return wanted;
+    // set client's room id to Lobby
+    client.setRoomId(0);
+}
+
+
+void Lobby::freeRoom(const int& id) {
+    // free slot of room only, when client is not in Lobby (and only once)
+    if (this->getRoom(id) != nullptr) {
+        this->occupied[id - 1] = false;
+        this->freeSlots.push_back(id - 1);
+
+        logger->info("Room id [%d] destroyed.", id);
+    }
 }
 
 
@@ -50,80 +76,106 @@ roomsIterator Lobby::getRoomById(const int& id) {
 
 
 
-int Lobby::createRoom(const std::string& client1, const std::string& client2) {
+int Lobby::createRoom(const Client& client1, const ClientHandle& handle1, const Client& client2, const ClientHandle& handle2) {
+    int id;
+
+    if (this->freeSlots.empty()) {
+        id = (int) this->games.size() + 1;
+        this->games.emplace_back(id, handle1, handle2);
+        this->occupied.push_back(true);
+    }
+    else {
+        id = this->freeSlots.back() + 1;
+        this->freeSlots.pop_back();
+        this->games[id - 1] = RoomHnefatafl(id, handle1, handle2);
+        this->occupied[id - 1] = true;
+    }
+
     this->roomsTotal += 1;
-    this->games.emplace_back(this->roomsTotal, client1, client2);
 
-    return this->roomsTotal;
+    logger->info("Game started with clients [%s] as black and [%s] as white. Room id [%d].", client1.getNick().c_str(), client2.getNick().c_str(), id);
+
+    return id;
 }
 
 
+/******************************************************************************
+ *
+ * 	Game played to the end is rated. The winner did last move, so the loser
+ * 	is on turn (in last state, when inaccessible).
+ *
+ */
 void Lobby::destroyRoom(const int& id, Client& client1, Client& client2) {
     State stateClient1 = client1.getState();
-    State stateClient2 = client2.getState();
+    RoomHnefatafl* room = this->getRoom(id);
 
-    // set states of both players to Waiting according to their connection/disconnection
-    // client 1
-    if (stateClient1 == Pinged || stateClient1 == Lost || stateClient1 == Disconnected) {
-        client1.setStateLast(Waiting);
-    }
-    else {
-        client1.setState(Waiting);
-    }
+    if (room != nullptr && room->getGameStatus() == Gameover) {
+        bool away = stateClient1 == Pinged || stateClient1 == Lost || stateClient1 == Disconnected;
 
-    // client 2
-    if (stateClient2 == Pinged || stateClient2 == Lost || stateClient2 == Disconnected) {
-        client2.setStateLast(Waiting);
-    }
-    else {
-        client2.setState(Waiting);
+        if ((away ? client1.getStateLast() : stateClient1) == PlayingOnTurn) {
+            this->rateGame(id, client2, client1);
+        }
+        else {
+            this->rateGame(id, client1, client2);
+        }
     }
 
-    // erase room only, when client is not in Lobby
-    if (id != 0) {
-        this->games.erase(this->getRoomById(id));
+    // id may be the one kept by client, so room goes first
+    this->freeRoom(id);
+    this->moveToLobby(client1);
+    this->moveToLobby(client2);
+}
 
-        logger->info("Room id [%d] destroyed.", id);
-    }
 
-    // set client's room id to Lobby
-    client1.setRoomId(0);
-    client2.setRoomId(0);
+/******************************************************************************
+ *
+ * 	Never should be needed, because room is destroyed together with erased
+ * 	client. Room is not rated, because the game may be not finished.
+ *
+ */
+void Lobby::destroyRoom(const int& id, Client& client) {
+    this->freeRoom(id);
+    this->moveToLobby(client);
 }
 
 
-bool Lobby::moveInRoom(const int& id, const std::string& coordinates) {
-    auto room = this->getRoomById(id);
-    bool moved = room->processMove(coordinates);
+void Lobby::reassignPlayer(const int& id, const ClientHandle& from, const ClientHandle& to) {
+    RoomHnefatafl* room = this->getRoom(id);
 
-    return moved;
+    if (room != nullptr) {
+        room->reassignPlayer(from, to);
+    }
 }
 
 
-//void Lobby::reassignPlayerIterator(clientsIterator& client) {
-//    auto room = this->getRoomById(client->getRoomId());
-//
-//    // clients must be compared by Nick
-//    if (client->getNick() == room->getPlayerOnTurn()->getNick()) {
-//        // set pointer to new instance to player on turn
-//        room->reassignPlayerOnTurn(client);
-//    }
-//    else {
-//        // set pointer to new instance to player on stand
-//        room->reassignPlayerOnStand(client);
-//    }
-//}
+// ----- GETTERS
 
 
-// ----- GETTERS
+/******************************************************************************
+ *
+ * 	Id comes from client, which may be in Lobby (0) or whose room was
+ * 	already destroyed, so it is checked before the slot is touched.
+ *
+ */
+RoomHnefatafl* Lobby::getRoom(const int& id) {
+    if (id < 1 || id > (int) this->games.size() || !this->occupied[id - 1]) {
+        return nullptr;
+    }
 
+    return &this->games[id - 1];
+}
 
-std::string Lobby::getOpponentOf(Client& client) {
+ClientHandle Lobby::getOpponentOf(const Client& client, const ClientHandle& handle) {
     // get room where client is
-    auto room = this->getRoomById(client.getRoomId());
+    const RoomHnefatafl* room = this->getRoom(client.getRoomId());
+
+    // client without room has no opponent
+    if (room == nullptr) {
+        return {-1, 0};
+    }
 
     // get other client in room as opponent
-    return client.getNick() == room->getPlayerOnTurn()
+    return handle == room->getPlayerOnTurn()
             ? room->getPlayerOnStand()
             : room->getPlayerOnTurn();
 }
@@ -132,18 +184,14 @@ const int& Lobby::getRoomsTotal() const {
     return this->roomsTotal;
 }
 
-const GameState& Lobby::getRoomStatus(const int& id) {
-    return this->getRoomById(id)->getGameStatus();
+bool Lobby::isFull() const {
+    return (int) (this->games.size() - this->freeSlots.size()) >= this->maxRooms;
 }
 
-std::string Lobby::getNickofPlayerOnTurn(const int& id) {
-    return this->getRoomById(id)->getPlayerOnTurn();
-}
 
-std::string Lobby::getNickofPlayerOnStand(const int& id) {
-    return this->getRoomById(id)->getPlayerOnStand();
-}
+// ----- SETTERS
+
 
-std::string Lobby::getPlayfieldString(const int& id) {
-    return this->getRoomById(id)->getPlayfieldString();
+void Lobby::setMaxRooms(const int& max) {
+    this->maxRooms = max;
 }
@@ -7,37 +7,57 @@
 #include "RoomHnefatafl.hpp"
 
 
-using roomsIterator = std::vector<RoomHnefatafl>::iterator;
-
+/******************************************************************************
+ *
+ * 	Rooms are kept in slots indexed by room id (id == slot + 1, 0 == lobby),
+ * 	so room is found and destroyed in O(1). Slot of destroyed room is reused
+ * 	by next game. Clients leave room id only together with the room, so id
+ * 	of reused slot never reaches a client of the old game.
+ *
+ */
 class Lobby {
 private:
 
-    /** Current ongoing games. */
+    /** Ongoing games by slots (free slot holds finished game). */
     std::vector<RoomHnefatafl> games;
+    /** Free slots, last freed is reused first. */
+    std::vector<int> freeSlots;
+    /** Slot holds ongoing game (by slots of games). */
+    std::vector<bool> occupied;
 
     /** Count of rooms ever created. */
     int roomsTotal;
-
-    /** Get iterator to room with given id. */
-    roomsIterator getRoomById(const int&);
+    /** Most ongoing games at once. */
+    int maxRooms;
+    /** Update ratings of players of finished game. */
+    void rateGame(const int&, Client&, Client&);
+    /** Player is Waiting in Lobby (after getting back, when inaccessible). */
+    void moveToLobby(Client&);
+    /** Free slot of destroyed room. */
+    void freeRoom(const int&);
 
 public:
     Lobby();
 
     /** Creates a room with new game. */
-    int createRoom(const std::string&, const std::string&);
+    int createRoom(const Client&, const ClientHandle&, const Client&, const ClientHandle&);
     /** Destroys a room with finished game. */
     void destroyRoom(const int&, Client&, Client&);
-    /** Send coordinated to room with given id. */
-    bool moveInRoom(const int&, const std::string&);
+    /** Destroys a room, whose other player does not exist anymore. */
+    void destroyRoom(const int&, Client&);
+    /** Give place of player in room with given id to new instance of the player. */
+    void reassignPlayer(const int&, const ClientHandle&, const ClientHandle&);
 
     // getters
-    [[nodiscard]] std::string getOpponentOf(Client&);
+    /** Get room with given id of ongoing game (nullptr == no such room). */
+    RoomHnefatafl* getRoom(const int&);
+    [[nodiscard]] ClientHandle getOpponentOf(const Client&, const ClientHandle&);
     [[nodiscard]] const int& getRoomsTotal() const;
-    [[nodiscard]] const GameState& getRoomStatus(const int&);
-    std::string getNickofPlayerOnTurn(const int&);
-    std::string getNickofPlayerOnStand(const int&);
-    std::string getPlayfieldString(const int&);
+    /** No other game can start until some ends. */
+    [[nodiscard]] bool isFull() const;
+
+    // setters
+    void setMaxRooms(const int&);
 
 };
 
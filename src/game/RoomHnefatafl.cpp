@@ -8,7 +8,7 @@
 
 
 
-RoomHnefatafl::RoomHnefatafl(const int& id, const std::string& pB, const std::string& pW) {
+RoomHnefatafl::RoomHnefatafl(const int& id, const ClientHandle& pB, const ClientHandle& pW) {
     // init room id and state
     this->roomId = id;
     this->gameState = Playing;
@@ -17,7 +17,7 @@ RoomHnefatafl::RoomHnefatafl(const int& id, const std::string& pB, const std::st
     this->onTurn = pB;
     this->onStand = pW;
 
-    // save player's nick for whole game, who is black and who is white
+    // save players for whole game, who is black and who is white
     this->black = pB;
     this->white = pW;
 
@@ -33,8 +33,6 @@ RoomHnefatafl::RoomHnefatafl(const int& id, const std::string& pB, const std::st
     this->pf[8]  = {F_Empty,  F_Empty, F_Empty, F_Empty, F_Empty, F_Empty, F_Empty, F_Empty, F_Empty, F_Empty, F_Empty};
     this->pf[9]  = {F_Empty,  F_Empty, F_Empty, F_Empty, F_Empty, S_Black, F_Empty, F_Empty, F_Empty, F_Empty, F_Empty};
     this->pf[10] = {F_Escape, F_Empty, F_Empty, S_Black, S_Black, S_Black, S_Black, S_Black, F_Empty, F_Empty, F_Escape};
-
-    logger->info("Game started with clients [%s] as black and [%s] as white. Room id [%d].", pB.c_str(), pW.c_str(), id);
 }
 
 
@@ -335,7 +333,7 @@ bool RoomHnefatafl::processMove(const std::string& coorStr) {
 
     // check if move is valid
     if (this->isValidMove()) {
-        logger->trace("Player [%s] moves to [%s].", this->onTurn.c_str(), coorStr.c_str());
+        logger->trace("Player in slot [%d] moves to [%s] in room [%d].", this->onTurn.index, coorStr.c_str(), this->roomId);
 
         // then move pieces
         this->move();
@@ -350,6 +348,21 @@ bool RoomHnefatafl::processMove(const std::string& coorStr) {
 }
 
 
+/******************************************************************************
+ *
+ * 	Client, who reconnected after long inaccessibility, is a new instance
+ * 	in other slot, so it takes every place of the old one.
+ *
+ */
+void RoomHnefatafl::reassignPlayer(const ClientHandle& from, const ClientHandle& to) {
+    for (ClientHandle* player : {&this->onTurn, &this->onStand, &this->black, &this->white}) {
+        if (*player == from) {
+            *player = to;
+        }
+    }
+}
+
+
 // ----- GETTERS
 
 
@@ -361,11 +374,11 @@ const GameState& RoomHnefatafl::getGameStatus() const {
     return this->gameState;
 }
 
-std::string RoomHnefatafl::getPlayerOnTurn() const {
+const ClientHandle& RoomHnefatafl::getPlayerOnTurn() const {
     return this->onTurn;
 }
 
-std::string RoomHnefatafl::getPlayerOnStand() const {
+const ClientHandle& RoomHnefatafl::getPlayerOnStand() const {
     return this->onStand;
 }
 
@@ -4,6 +4,8 @@
 #include <string>
 #include <array>
 
+#include "../network/ClientHandle.hpp"
+
 
 enum GameState {
     Playing,
@@ -34,13 +36,13 @@ private:
     GameState gameState;
 
     /** Player on turn. */
-    std::string onTurn;
+    ClientHandle onTurn;
     /** Player standing by. */
-    std::string onStand;
+    ClientHandle onStand;
     /** Black attacker player. */
-    std::string black;
+    ClientHandle black;
     /** White defending player. */
-    std::string white;
+    ClientHandle white;
 
     /** Position on playfield to move from. */
     int xFrom, yFrom;
@@ -83,16 +85,18 @@ private:
 
 public:
 
-    RoomHnefatafl(const int&, const std::string&, const std::string&);
+    RoomHnefatafl(const int&, const ClientHandle&, const ClientHandle&);
 
     /** Process requested move of played. */
     bool processMove(const std::string&);
+    /** Give place of player to new instance of the player (reconnection). */
+    void reassignPlayer(const ClientHandle&, const ClientHandle&);
 
     // getters
     [[nodiscard]] const int& getRoomId() const;
     [[nodiscard]] const GameState& getGameStatus() const;
-    [[nodiscard]] std::string getPlayerOnTurn() const;
-    [[nodiscard]] std::string getPlayerOnStand() const;
+    [[nodiscard]] const ClientHandle& getPlayerOnTurn() const;
+    [[nodiscard]] const ClientHandle& getPlayerOnStand() const;
     [[nodiscard]] std::string getPlayfieldString() const;
 
 };
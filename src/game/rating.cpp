@@ -0,0 +1,19 @@
+#include <cmath>
+
+#include "rating.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Elo rating -- winner gets as many points as loser loses. Expected score
+ * 	of winner is small, when loser was rated higher, so the upset is worth
+ * 	more points.
+ *
+ */
+void updateRatings(int& winner, int& loser) {
+    double expected = 1.0 / (1.0 + std::pow(10.0, (loser - winner) / 400.0));
+    int points = (int) std::lround(RATING_K * (1.0 - expected));
+
+    winner += points;
+    loser -= points;
+}
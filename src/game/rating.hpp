@@ -0,0 +1,14 @@
+#ifndef RATING_HPP
+#define RATING_HPP
+
+
+/** Rating of player, who did not finish any game yet. */
+constexpr const int RATING_INITIAL = 1500;
+/** Most points won or lost in one game. */
+constexpr const int RATING_K = 32;
+
+/** Update Elo ratings of winner and loser of finished game. */
+void updateRatings(int&, int&);
+
+
+#endif
@@ -1,181 +1,340 @@
-#include <sstream>
-
-#include "Client.hpp"
-
-
-// ---------- CONSTRUCTORS & DESTRUCTORS
-
-
-
-
-
-Client::Client(const std::string& ip, const int& sock) {
-    this->flagToDisconnect = false;
-    this->flagToErase = false;
-    this->discReason = "none";
-    this->cntrPings = LONG_PING;
-    this->ipAddress = ip;
-    this->socketNum = sock;
-    this->roomId = 0;
-    this->state = New;
-    this->stateLast = New;
-}
-
-
-
-
-
-// ---------- PRIVATE METHODS
-
-
-
-
-
-
-
-
-
-
-// ---------- PUBLIC METHODS
-
-
-
-
-
-void Client::decreaseInaccessCount() {
-    this->cntrPings -= 1;
-}
-
-void Client::resetInaccessCount() {
-    this->cntrPings = LONG_PING;
-}
-
-
-// ----- SETTERS
-
-
-void Client::setSocket(const int& sock) {
-    this->socketNum = sock;
-}
-
-void Client::setRoomId(const int& id) {
-    this->roomId = id;
-}
-
-void Client::setState(State s) {
-    if (!(this->state == Pinged || this->state == Lost || this->state == Disconnected)) {
-        this->stateLast = this->state;
-    }
-    this->state = s;
-}
-
-void Client::setStateLast(State s) {
-    this->stateLast = s;
-}
-
-void Client::setNick(const std::string& n) {
-    this->nick = n;
-}
-
-void Client::setFlagToDisconnect(const bool& value, const std::string& reason) {
-    this->flagToDisconnect = value;
-    this->discReason = reason;
-}
-
-void Client::setFlagToErase(const bool& value) {
-    this->flagToErase = value;
-}
-
-
-// ----- GETTERS
-
-
-const std::string& Client::getIpAddr() const {
-    return this->ipAddress;
-}
-
-const int& Client::getSocket() const {
-    return this->socketNum;
-}
-
-const int& Client::getRoomId() const {
-    return this->roomId;
-}
-
-const std::string& Client::getNick() const {
-    return this->nick;
-}
-
-State Client::getState() const {
-    return this->state;
-}
-
-State Client::getStateLast() const {
-    return this->stateLast;
-}
-
-const int& Client::getInaccessCount() const {
-    return this->cntrPings;
-}
-
-const bool& Client::getFlagToDisconnect() const {
-    return this->flagToDisconnect;
-}
-
-const bool& Client::getFlagToErase() const {
-    return this->flagToErase;
-}
-
-const char* Client::getReason() const {
-    return this->discReason.c_str();
-}
-
-// ----- PRINTERS
-
-std::string Client::toStringState() const {
-    std::string state_str;
-
-    switch (this->state) {
-        case New:
-            state_str = "new";
-            break;
-        case Waiting:
-            state_str = "waiting";
-            break;
-        case Ready:
-            state_str = "ready";
-            break;
-        case PlayingOnTurn:
-            state_str = "on turn";
-            break;
-        case PlayingOnStand:
-            state_str = "on stand";
-            break;
-        case Pinged:
-            state_str = "pinged";
-            break;
-        case Lost:
-            state_str = "lost";
-            break;
-        case Disconnected:
-            state_str = "disconnected";
-            break;
-        default:
-            // never should get here
-            state_str = "unknown";
-    }
-
-    return state_str;
-}
-
-std::string Client::toString() const {
-    std::stringstream out;
-
-    out << "socket ["     << this->socketNum
-        << "], nick ["    << this->nick
-        << "], state ["   << this->toStringState()
-        << "], roomId ["  << this->roomId
-        << "]" << std::endl;
-
-    return out.str();
-}
+// inet_ntop()
+#include <arpa/inet.h>
+
+#include <sstream>
+
+#include "../game/rating.hpp"
+#include "Client.hpp"
+#include "ClientTable.hpp"
+
+
+/** Printable reasons of disconnection, by DiscReason. */
+constexpr const char* REASONS[] = {
+    "none",
+    "closed",
+    "useless instance",
+    "not responding",
+    "session resumed",
+    "output overflow",
+    "sending failed",
+    "handover failed"
+};
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+Client::Client(const std::uint32_t& ip, const int& sock) {
+    this->flagToDisconnect = false;
+    this->flagToErase = false;
+    this->state = New;
+    this->stateLast = New;
+    this->cntrPings = LONG_PING;
+    this->rating = RATING_INITIAL;
+    this->discReason = D_None;
+    this->ipAddress = ip;
+    this->socketNum = sock;
+    this->roomId = 0;
+    this->shardToMove = -1;
+    this->timerKey = -1;
+    this->binary = false;
+    this->token = 0;
+    this->ring = RingBuffer();
+    this->outbox = OutBuffer();
+    this->table = nullptr;
+    this->slot = -1;
+}
+
+
+
+
+
+// ---------- PRIVATE METHODS
+
+
+
+
+
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void Client::decreaseInaccessCount() {
+    if (this->table != nullptr) {
+        this->table->setInaccessCount(this->slot, this->table->getInaccessCount(this->slot) - 1);
+    }
+    else {
+        this->cntrPings -= 1;
+    }
+}
+
+void Client::resetInaccessCount() {
+    if (this->table != nullptr) {
+        this->table->setInaccessCount(this->slot, LONG_PING);
+    }
+    else {
+        this->cntrPings = LONG_PING;
+    }
+}
+
+
+// ----- SETTERS
+
+
+void Client::setSocket(const int& sock) {
+    this->socketNum = sock;
+}
+
+void Client::setRoomId(const int& id) {
+    this->roomId = id;
+}
+
+void Client::setState(State s) {
+    State current = this->getState();
+
+    if (!(current == Pinged || current == Lost || current == Disconnected)) {
+        this->setStateLast(current);
+    }
+
+    if (this->table != nullptr) {
+        this->table->setState(this->slot, s);
+    }
+    else {
+        this->state = s;
+    }
+}
+
+void Client::setStateLast(State s) {
+    if (this->table != nullptr) {
+        this->table->setStateLast(this->slot, s);
+    }
+    else {
+        this->stateLast = s;
+    }
+}
+
+/******************************************************************************
+ *
+ * 	Nick is kept in table by slot of client, so client, which is not
+ * 	in slot map, has no nick.
+ *
+ */
+void Client::setNick(const std::string& n) {
+    if (this->table != nullptr) {
+        this->table->setNick(this->slot, n);
+    }
+}
+
+void Client::setFlagToDisconnect(const bool& value, const DiscReason& reason) {
+    this->discReason = reason;
+
+    if (this->table != nullptr) {
+        this->table->setFlagToDisconnect(this->slot, value);
+    }
+    else {
+        this->flagToDisconnect = value;
+    }
+}
+
+void Client::setFlagToErase(const bool& value) {
+    if (this->table != nullptr) {
+        this->table->setFlagToErase(this->slot, value);
+    }
+    else {
+        this->flagToErase = value;
+    }
+}
+
+void Client::setShardToMove(const int& shard) {
+    this->shardToMove = shard;
+}
+
+void Client::setTimerKey(const int& key) {
+    this->timerKey = key;
+}
+
+void Client::setBinary(const bool& binary) {
+    this->binary = binary;
+}
+
+void Client::setRating(const int& r) {
+    if (this->table != nullptr) {
+        this->table->setRating(this->slot, r);
+    }
+    else {
+        this->rating = r;
+    }
+}
+
+void Client::setToken(const std::uint64_t& t) {
+    this->token = t;
+}
+
+/******************************************************************************
+ *
+ * 	Hot state goes with client -- client leaving slot map (handed over)
+ * 	takes it from table of the old one, client getting to slot map gives
+ * 	it to table of the new one. Only one of them holds it at a time.
+ *
+ */
+void Client::setTable(ClientTable* t, const int& s) {
+    if (this->table != nullptr) {
+        this->flagToDisconnect = this->table->getFlagToDisconnect(this->slot);
+        this->flagToErase = this->table->getFlagToErase(this->slot);
+        this->state = this->table->getState(this->slot);
+        this->stateLast = this->table->getStateLast(this->slot);
+        this->cntrPings = this->table->getInaccessCount(this->slot);
+        this->rating = this->table->getRating(this->slot);
+        this->table = nullptr;
+    }
+
+    // store reads hot state of client, while it is not in slot map yet
+    if (t != nullptr) {
+        t->store(s, *this);
+    }
+
+    this->table = t;
+    this->slot = s;
+}
+
+
+// ----- GETTERS
+
+
+const std::uint32_t& Client::getIpAddr() const {
+    return this->ipAddress;
+}
+
+const int& Client::getSocket() const {
+    return this->socketNum;
+}
+
+const int& Client::getRoomId() const {
+    return this->roomId;
+}
+
+const std::string& Client::getNick() const {
+    static const std::string none;
+
+    return this->table != nullptr ? this->table->getNick(this->slot) : none;
+}
+
+State Client::getState() const {
+    return this->table != nullptr ? this->table->getState(this->slot) : this->state;
+}
+
+State Client::getStateLast() const {
+    return this->table != nullptr ? this->table->getStateLast(this->slot) : this->stateLast;
+}
+
+const int& Client::getInaccessCount() const {
+    return this->table != nullptr ? this->table->getInaccessCount(this->slot) : this->cntrPings;
+}
+
+bool Client::getFlagToDisconnect() const {
+    return this->table != nullptr ? this->table->getFlagToDisconnect(this->slot) : this->flagToDisconnect;
+}
+
+bool Client::getFlagToErase() const {
+    return this->table != nullptr ? this->table->getFlagToErase(this->slot) : this->flagToErase;
+}
+
+const char* Client::getReason() const {
+    return REASONS[this->discReason];
+}
+
+const int& Client::getShardToMove() const {
+    return this->shardToMove;
+}
+
+const int& Client::getTimerKey() const {
+    return this->timerKey;
+}
+
+const bool& Client::isBinary() const {
+    return this->binary;
+}
+
+const int& Client::getRating() const {
+    return this->table != nullptr ? this->table->getRating(this->slot) : this->rating;
+}
+
+const std::uint64_t& Client::getToken() const {
+    return this->token;
+}
+
+RingBuffer& Client::getRing() {
+    return this->ring;
+}
+
+OutBuffer& Client::getOutbox() {
+    return this->outbox;
+}
+
+// ----- PRINTERS
+
+std::string Client::toStringIpAddr() const {
+    char ip[INET_ADDRSTRLEN] = "0.0.0.0";
+
+    inet_ntop(AF_INET, &this->ipAddress, ip, sizeof(ip));
+
+    return std::string(ip);
+}
+
+std::string Client::toStringState() const {
+    std::string state_str;
+
+    switch (this->getState()) {
+        case New:
+            state_str = "new";
+            break;
+        case Waiting:
+            state_str = "waiting";
+            break;
+        case Ready:
+            state_str = "ready";
+            break;
+        case PlayingOnTurn:
+            state_str = "on turn";
+            break;
+        case PlayingOnStand:
+            state_str = "on stand";
+            break;
+        case Pinged:
+            state_str = "pinged";
+            break;
+        case Lost:
+            state_str = "lost";
+            break;
+        case Disconnected:
+            state_str = "disconnected";
+            break;
+        default:
+            // never should get here
+            state_str = "unknown";
+    }
+
+    return state_str;
+}
+
+std::string Client::toString() const {
+    std::stringstream out;
+
+    out << "socket ["     << this->socketNum
+        << "], nick ["    << this->getNick()
+        << "], state ["   << this->toStringState()
+        << "], roomId ["  << this->roomId
+        << "]" << std::endl;
+
+    return out.str();
+}
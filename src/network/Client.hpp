@@ -1,83 +1,132 @@
-#ifndef CLIENT_HPP
-#define CLIENT_HPP
-
-#include <string>
-
-
-enum State {
-    New,
-    Waiting,
-    Ready,
-    PlayingOnTurn,
-    PlayingOnStand,
-    Pinged,
-    Lost,
-    Disconnected
-};
-
-
-class Client {
-private:
-    /** Count of pings during long inaccessibility -- duration. */
-    constexpr static const int LONG_PING = 2;
-
-    /** Flag, which marks client's connection as to disconnect. */
-    bool flagToDisconnect;
-    /** Flag, which marks client's instance as to erase. */
-    bool flagToErase;
-    /** If client is going to be disconnected (flagToDisconnect == true), then this tells the reason. */
-    std::string discReason;
-
-    /** Counter of long inaccessibility pings. */
-    int cntrPings;
-
-    /** IP address of client. */
-    std::string ipAddress;
-    /** Socket client is connected to. */
-    int socketNum;
-
-    /** Room where player is located. (0 == lobby) */
-    int roomId;
-    /** Player"s nick sent by the player. */
-    std::string nick;
-    /** Player's state during connection. */
-    State state;
-    /** Store last client's state after pinging. */
-    State stateLast;
-
-public:
-
-    Client(const std::string&, const int&);
-
-    /** Decreases counter during long inaccessibility. */
-    void decreaseInaccessCount();
-    /** Resets counter of long inaccessibility */
-    void resetInaccessCount();
-
-    // getters
-    [[nodiscard]] const std::string& getIpAddr() const;
-    [[nodiscard]] const int& getSocket() const;
-    [[nodiscard]] const int& getRoomId() const;
-    [[nodiscard]] const std::string& getNick() const;
-    [[nodiscard]] State getState() const;
-    [[nodiscard]] State getStateLast() const;
-    [[nodiscard]] const int& getInaccessCount() const;
-    [[nodiscard]] const bool& getFlagToDisconnect() const;
-    [[nodiscard]] const bool& getFlagToErase() const;
-    [[nodiscard]] const char* getReason() const;
-
-    // setters
-    void setSocket(const int&);
-    void setRoomId(const int&);
-    void setState(State s);
-    void setStateLast(State s);
-    void setNick(const std::string&);
-    void setFlagToDisconnect(const bool&, const std::string&);
-    void setFlagToErase(const bool&);
-
-    // printers
-    [[nodiscard]] std::string toStringState() const;
-    [[nodiscard]] std::string toString() const;
-};
-
-#endif
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "OutBuffer.hpp"
+#include "RingBuffer.hpp"
+
+
+class ClientTable;
+
+enum State : unsigned char {
+    New,
+    Waiting,
+    Ready,
+    PlayingOnTurn,
+    PlayingOnStand,
+    Pinged,
+    Lost,
+    Disconnected
+};
+
+enum DiscReason : unsigned char {
+    D_None,
+    D_Closed,
+    D_UselessInstance,
+    D_NotResponding,
+    D_SessionResumed,
+    D_OutputOverflow,
+    D_SendingFailed,
+    D_HandoverFailed
+};
+
+
+class Client {
+private:
+    /** Count of pings during long inaccessibility -- duration. */
+    constexpr static const int LONG_PING = 2;
+
+    // hot state -- only of client, which is not in slot map (table keeps it by slot otherwise)
+
+    /** Flag, which marks client's connection as to disconnect. */
+    bool flagToDisconnect;
+    /** Flag, which marks client's instance as to erase. */
+    bool flagToErase;
+    /** Player's state during connection. */
+    State state;
+    /** Store last client's state after pinging. */
+    State stateLast;
+    /** Counter of long inaccessibility pings. */
+    int cntrPings;
+    /** Elo rating of player. */
+    int rating;
+
+    /** If client is going to be disconnected (flagToDisconnect == true), then this tells the reason. */
+    DiscReason discReason;
+
+    /** IPv4 address of client (network byte order). */
+    std::uint32_t ipAddress;
+    /** Socket client is connected to. */
+    int socketNum;
+
+    /** Room where player is located. (0 == lobby) */
+    int roomId;
+    /** Shard, where client has to be handed over (-1 == stay). */
+    int shardToMove;
+    /** Key of client's heartbeat timer, unique in shard. */
+    int timerKey;
+    /** Client talks binary protocol (chosen on connection). */
+    bool binary;
+    /** Session token, which client resumes its session with (0 == none). */
+    std::uint64_t token;
+    /** Received data, which were not served yet (unfinished frame). */
+    RingBuffer ring;
+    /** Frames, which were not sent yet. */
+    OutBuffer outbox;
+    /** Table, which keeps hot state of client (nullptr == client is not in slot map). */
+    ClientTable* table;
+    /** Slot of client in table (nick is there too). */
+    int slot;
+
+public:
+
+    Client(const std::uint32_t&, const int&);
+
+    /** Decreases counter during long inaccessibility. */
+    void decreaseInaccessCount();
+    /** Resets counter of long inaccessibility */
+    void resetInaccessCount();
+
+    // getters
+    [[nodiscard]] const std::uint32_t& getIpAddr() const;
+    [[nodiscard]] const int& getSocket() const;
+    [[nodiscard]] const int& getRoomId() const;
+    [[nodiscard]] const std::string& getNick() const;
+    [[nodiscard]] State getState() const;
+    [[nodiscard]] State getStateLast() const;
+    [[nodiscard]] const int& getInaccessCount() const;
+    [[nodiscard]] bool getFlagToDisconnect() const;
+    [[nodiscard]] bool getFlagToErase() const;
+    [[nodiscard]] const char* getReason() const;
+    [[nodiscard]] const int& getShardToMove() const;
+    [[nodiscard]] const int& getTimerKey() const;
+    [[nodiscard]] const bool& isBinary() const;
+    [[nodiscard]] const int& getRating() const;
+    [[nodiscard]] const std::uint64_t& getToken() const;
+    RingBuffer& getRing();
+    OutBuffer& getOutbox();
+
+    // setters
+    void setSocket(const int&);
+    void setRoomId(const int&);
+    void setState(State s);
+    void setStateLast(State s);
+    void setNick(const std::string&);
+    void setFlagToDisconnect(const bool&, const DiscReason&);
+    void setFlagToErase(const bool&);
+    void setShardToMove(const int&);
+    void setTimerKey(const int&);
+    void setBinary(const bool&);
+    void setRating(const int&);
+    void setToken(const std::uint64_t&);
+    void setTable(ClientTable*, const int&);
+
+    // printers
+    [[nodiscard]] std::string toStringIpAddr() const;
+    [[nodiscard]] std::string toStringState() const;
+    [[nodiscard]] std::string toString() const;
+};
+
+#endif
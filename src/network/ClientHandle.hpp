@@ -0,0 +1,28 @@
+#ifndef CLIENT_HANDLE_HPP
+#define CLIENT_HANDLE_HPP
+
+
+/******************************************************************************
+ *
+ * 	Stable reference to client in slot map of clients. Slot is reused after
+ * 	the client is erased, but with next generation, so old handle of erased
+ * 	client never finds the new one.
+ *
+ */
+struct ClientHandle {
+    /** Slot of client. (-1 == no client) */
+    int index;
+    /** Generation of slot, when the handle was taken. */
+    unsigned generation;
+
+    bool operator==(const ClientHandle& other) const {
+        return this->index == other.index && this->generation == other.generation;
+    }
+
+    bool operator!=(const ClientHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+
+#endif
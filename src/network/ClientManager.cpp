@@ -1,10 +1,42 @@
-#include <sys/socket.h>
+// getrandom()
+#include <sys/random.h>
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 #include "../system/Logger.hpp"
+#include "binary_codec.hpp"
 #include "ClientManager.hpp"
 
 
+/******************************************************************************
+ *
+ * 	Legal requests of client in each state. Connection, ping and pong
+ * 	are checked further in their handlers, the rest only here.
+ * 	Pinged client is not restricted by its last state here.
+ *
+ */
+constexpr const ClientManager::Handler ClientManager::ROUTES[OPCODES][STATES] = {
+    //                  New                               Waiting                           Ready                             PlayingOnTurn                     PlayingOnStand                    Pinged                            Lost                              Disconnected
+    /* O_Unknown   */ { nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr                          },
+    /* O_Ping      */ { &ClientManager::requestPing,      &ClientManager::requestPing,      &ClientManager::requestPing,      &ClientManager::requestPing,      &ClientManager::requestPing,      &ClientManager::requestPing,      &ClientManager::requestPing,      &ClientManager::requestPing      },
+    /* O_Pong      */ { &ClientManager::requestPong,      &ClientManager::requestPong,      &ClientManager::requestPong,      &ClientManager::requestPong,      &ClientManager::requestPong,      &ClientManager::requestPong,      &ClientManager::requestPong,      &ClientManager::requestPong      },
+    /* O_Conn      */ { &ClientManager::requestConnect,   &ClientManager::requestConnect,   &ClientManager::requestConnect,   &ClientManager::requestConnect,   &ClientManager::requestConnect,   &ClientManager::requestConnect,   &ClientManager::requestConnect,   &ClientManager::requestConnect   },
+    /* O_ConnBin   */ { &ClientManager::requestConnBin,   &ClientManager::requestConnBin,   &ClientManager::requestConnBin,   &ClientManager::requestConnBin,   &ClientManager::requestConnBin,   &ClientManager::requestConnBin,   &ClientManager::requestConnBin,   &ClientManager::requestConnBin   },
+    /* O_Resume    */ { &ClientManager::requestResume,    &ClientManager::requestResume,    &ClientManager::requestResume,    &ClientManager::requestResume,    &ClientManager::requestResume,    &ClientManager::requestResume,    &ClientManager::requestResume,    &ClientManager::requestResume    },
+    /* O_ResumeBin */ { &ClientManager::requestResumeBin, &ClientManager::requestResumeBin, &ClientManager::requestResumeBin, &ClientManager::requestResumeBin, &ClientManager::requestResumeBin, &ClientManager::requestResumeBin, &ClientManager::requestResumeBin, &ClientManager::requestResumeBin },
+    /* O_Ready     */ { nullptr,                          &ClientManager::requestReady,     nullptr,                          nullptr,                          nullptr,                          &ClientManager::requestReady,     nullptr,                          nullptr                          },
+    /* O_Move      */ { nullptr,                          nullptr,                          nullptr,                          &ClientManager::requestMove,      nullptr,                          &ClientManager::requestMove,      nullptr,                          nullptr                          },
+    /* O_Leave     */ { nullptr,                          nullptr,                          nullptr,                          &ClientManager::requestLeave,     &ClientManager::requestLeave,     &ClientManager::requestLeave,     nullptr,                          nullptr                          },
+    /* O_Chat      */ { nullptr,                          nullptr,                          nullptr,                          &ClientManager::requestChat,      &ClientManager::requestChat,      &ClientManager::requestChat,      nullptr,                          nullptr                          },
+    /* O_Ok        */ { nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr,                          nullptr                          },
+};
+
+
 // ---------- CONSTRUCTORS & DESTRUCTORS
 
 
@@ -12,7 +44,23 @@
 
 
 ClientManager::ClientManager() {
-    this->clients = std::vector<Client>();
+    this->reactor = nullptr;
+
+    this->shards = nullptr;
+    this->shardId = 0;
+
+    this->clients = ClientSlots();
+    this->socketIndex = std::vector<int>();
+    this->timerIndex = std::unordered_map<int, int>();
+    this->nickIndex = NickIndex(&this->clients.getTable());
+    this->tokenIndex = std::unordered_map<std::uint64_t, int>();
+    this->nextTimerKey = 0;
+
+    this->flagged = false;
+    this->rated = false;
+
+    this->outLimit = 0;
+    this->dirty = std::vector<int>();
 
     this->cli_connected = 0;
     this->cli_disconnected = 0;
@@ -30,75 +78,134 @@ ClientManager::ClientManager() {
 
 
 
+
 /******************************************************************************
  *
- * 	If everything was processed successfully, return 0, else return -1
- * 	eg. when client can't receive actual data according to one's state
- * 	or when invalid move for game is received.
+ * 	Key of timer is new also for adopted client, so timer left in wheel
+ * 	of the other shard never finds it.
  *
  */
-int ClientManager::routeRequest(Client& client, request& rqst) {
-    int processed = 0;
-    State state;
-    std::string key;
+void ClientManager::indexClient(clientsIterator& client) {
+    int sock = client->getSocket();
+    int slot = client.getIndex();
 
-    // loop over every data in queue
-    while (!rqst.empty()) {
-        // get current state of client
-        state = client.getState();
-        // get first element in queue
-        key = rqst.front();
+    if (sock >= (int) this->socketIndex.size()) {
+        this->socketIndex.resize(sock + 1, -1);
+    }
+    this->socketIndex[sock] = slot;
 
-        logger->trace("KEY [%s] socket [%d] nick [%s] state [%s].", key.c_str(), client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
+    client->setTimerKey(this->nextTimerKey++);
+    this->timerIndex[client->getTimerKey()] = slot;
 
-        // connection request
-        if (key == Protocol::CC_CONN) {
-            // key is ok
-            rqst.pop();
+    // adopted client may already have nick and session
+    if (!client->getNick().empty()) {
+        this->nickIndex.insert(client->getNick(), slot);
+    }
+    if (client->getToken() != 0) {
+        this->tokenIndex[client->getToken()] = slot;
+    }
+}
 
-            processed = this->requestConnect(client, rqst.front(), state);
-        }
-        // client is ready to play a game
-        else if (key == Protocol::CC_READY && (state == Waiting || state == Pinged)) {
-            processed = this->requestReady(client);
-        }
-        // move in game request
-        else if (key == Protocol::CC_MOVE && (state == PlayingOnTurn || state == Pinged)) {
-            // key is ok
-            rqst.pop();
 
-            processed = this->requestMove(client, rqst.front());
-        }
-        // leave the game request
-        else if (key == Protocol::CC_LEAV && (state == PlayingOnTurn || state == PlayingOnStand || state == Pinged)) {
-            processed = this->requestLeave(client);
-        }
-        // ping enquiry
-        else if (key == Protocol::OP_PING) {
-            processed = this->requestPing(client, state);
-        }
-        // pong acknowledge (pong may still come after short inaccessibility)
-        else if (key == Protocol::OP_PONG) {
-            processed = this->requestPong(client);
-        }
-        // chat message
-        else if (key == Protocol::OP_CHAT && (state == PlayingOnTurn || state == PlayingOnStand || state == Pinged)) {
-            // key is ok
-            rqst.pop();
+void ClientManager::unindexClient(const Client& client) {
+    // client with closed connection does not have socket anymore
+    if (client.getSocket() >= 0) {
+        this->socketIndex[client.getSocket()] = -1;
+    }
 
-            processed = this->requestChat(client, rqst.front());
-        }
-        // violation of server logic leads to disconnection of client
-        else {
-            processed = -1;
-            break;
+    this->timerIndex.erase(client.getTimerKey());
+
+    if (!client.getNick().empty() && this->nickIndex.find(client.getNick()) == this->clients.handleOf(client).index) {
+        this->nickIndex.erase(client.getNick());
+    }
+
+    auto session = this->tokenIndex.find(client.getToken());
+
+    if (session != this->tokenIndex.end() && session->second == this->clients.handleOf(client).index) {
+        this->tokenIndex.erase(session);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	During reconnection, new instance of client takes nick before the old
+ * 	one loses it, so nick is removed from index only by client it points to.
+ *
+ */
+void ClientManager::renameClient(Client& client, const std::string& nick) {
+    int position = this->clients.handleOf(client).index;
+
+    if (!client.getNick().empty() && this->nickIndex.find(client.getNick()) == position) {
+        this->nickIndex.erase(client.getNick());
+    }
+
+    client.setNick(nick);
+
+    if (!nick.empty()) {
+        this->nickIndex.insert(nick, position);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Same as with nicks, new instance takes token before the old one loses it.
+ *
+ */
+void ClientManager::bindToken(Client& client, const std::uint64_t& token) {
+    int position = this->clients.handleOf(client).index;
+    auto session = this->tokenIndex.find(client.getToken());
+
+    if (session != this->tokenIndex.end() && session->second == position) {
+        this->tokenIndex.erase(session);
+    }
+
+    client.setToken(token);
+
+    if (token != 0) {
+        this->tokenIndex[token] = position;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Token is random, so nobody guesses session of other client. Zero means
+ * 	no token and token used by other client (even on other shard) is drawn
+ * 	again.
+ *
+ */
+std::uint64_t ClientManager::createToken(const std::string& nick) {
+    std::uint64_t token = 0;
+
+    while (token == 0 || this->tokenIndex.count(token) != 0 || !this->shards->claimToken(token, nick)) {
+        if (getrandom(&token, sizeof(token), 0) != sizeof(token)) {
+            throw std::runtime_error(std::string("Unable to create session token."));
         }
+    }
+
+    return token;
+}
+
+/******************************************************************************
+ *
+ * 	If everything was processed successfully, return 0, else return -1
+ * 	eg. when client can't send the request in one's state
+ * 	or when invalid move for game is received.
+ *
+ */
+int ClientManager::routeRequest(Client& client, const request& rqst) {
+    Handler handler = ROUTES[rqst.op][client.getState()];
+
+    logger->trace("KEY [%.*s] socket [%d] nick [%s] state [%s].", (int) rqst.key.length(), rqst.key.data(), client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
 
-        // go to next request element in queue
-        rqst.pop();
+    // violation of server logic leads to disconnection of client
+    if (handler == nullptr) {
+        return -1;
     }
 
-    return processed;
+    return (this->*handler)(client, rqst);
 }
 
 
@@ -111,7 +218,7 @@ int ClientManager::routeRequest(Client& client, request& rqst) {
  * 	advice: dont try to understand complete flow, because even i do not
  *
  */
-void ClientManager::handleReconnection(Client& client, clientsIterator& clientOtherIpaddr, const std::string& nick) {
+void ClientManager::handleReconnection(Client& client, clientsIterator& clientOtherIpaddr, const bool& binary) {
     State clientOtherIpaddrState = clientOtherIpaddr->getState();
 
     // note: client == clientOtherIpaddr for `if` and `else if`
@@ -122,57 +229,116 @@ void ClientManager::handleReconnection(Client& client, clientsIterator& clientOt
     // for less than one server ping period, so it sends a connect request, but server did not marked
     // the client as Pinged... or somebody is again sending messages with telnet
     if (clientOtherIpaddrState == Waiting || clientOtherIpaddrState == PlayingOnTurn || clientOtherIpaddrState == PlayingOnStand) {
-        this->sendToClient(client, Protocol::SC_NICK_USED);
+        this->sendToClient(client, Protocol::FRAME_NICK_USED);
     }
         // short inaccessibility reconnection (without stealing from expired instance)
     else if (clientOtherIpaddrState == Pinged || clientOtherIpaddrState == Lost) {
         client.setState(client.getStateLast());
 
-        // client was in Lobby -- send message about being back in Lobby
-        if (client.getRoomId() == 0) {
-            this->sendToClient(client, this->composeMsgInLobbyRecn());
-        }
-        // client was in game -- send message about being back in game
-        else {
-            // and send game status
-            this->sendToClient(client, this->composeMsgInGameRecn(client));
-            // inform opponent
-            this->sendToOpponentOf(client, Protocol::SC_OPN_RECN);
-        }
-
-        this->cli_reconnected += 1;
-        logger->info("Client [%s] on socket [%d] in room id [%d] reconnected.", client.getNick().c_str(), client.getSocket(), client.getRoomId());
+        this->acceptBinary(client, binary);
+        this->sendReconnected(client);
     }
         // long inaccessibility reconnection -- state Disconnected (with stealing from expired instance)
     else {
-        // set nick as before disconnections
-        client.setNick(nick);
-        // set last state as before disconnection
-        client.setState(clientOtherIpaddr->getStateLast());
-        // set room id as before disconnection
-        client.setRoomId(clientOtherIpaddr->getRoomId());
-
-        // reset inaccessibility ping count
-        client.resetInaccessCount();
-
-        // this instance will not be used anymore, so set its nick to nothing
-        clientOtherIpaddr->setNick("");
-        // and set erase flag
-        clientOtherIpaddr->setFlagToErase(true);
-
-        // client was in Lobby -- send message about being back in Lobby
-        if (client.getRoomId() == 0) {
-            this->sendToClient(client, this->composeMsgInLobbyRecn());
-        }
-        else {
-            // and send game status
-            this->sendToClient(client, this->composeMsgInGameRecn(client));
-            // inform opponent
-            this->sendToOpponentOf(client, Protocol::SC_OPN_RECN);
-        }
+        this->takeOverClient(client, clientOtherIpaddr, binary);
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	New instance takes nick, rating, state, room and session token of old one,
+ * 	which is erased then. Old instance with open connection (client resumed
+ * 	session from other network, when the old connection stopped answering
+ * 	pings, but was not closed yet) is out of game and disconnected first.
+ *
+ */
+void ClientManager::takeOverClient(Client& client, clientsIterator& old, const bool& binary) {
+    State state = old->getState();
+
+    // state before inaccessibility, if there was some
+    if (state == Pinged || state == Lost || state == Disconnected) {
+        state = old->getStateLast();
+    }
 
-        this->cli_reconnected += 1;
-        logger->info("Client [%s] on socket [%d] in room id [%d] reconnected.", client.getNick().c_str(), client.getSocket(), client.getRoomId());
+    // set nick as before disconnections
+    this->renameClient(client, old->getNick());
+    // set rating as before disconnection (before state, it tells queue of Ready client)
+    client.setRating(old->getRating());
+    // set last state as before disconnection
+    client.setState(state);
+    // Ready client keeps its place in time, so also its widened window of ratings
+    this->clients.setReadySince(client, this->clients.getTable().getReadySince(old.getIndex()));
+    // set room id as before disconnection
+    client.setRoomId(old->getRoomId());
+
+    // take place of old instance in the game
+    if (client.getRoomId() != 0) {
+        this->lobby.reassignPlayer(client.getRoomId(), this->clients.handleOf(*old), this->clients.handleOf(client));
+    }
+
+    // reset inaccessibility ping count
+    client.resetInaccessCount();
+    // session goes on with new instance
+    this->bindToken(client, old->getToken());
+
+    // this instance will not be used anymore, so set its nick and token to nothing
+    this->renameClient(*old, "");
+    this->bindToken(*old, 0);
+    old->setRoomId(0);
+
+    // old connection is still open, so it is closed (not Ready and not playing anymore)
+    if (old->getSocket() >= 0) {
+        old->setState(New);
+        old->setStateLast(New);
+        this->sendToClient(*old, Protocol::FRAME_KICK);
+        old->setFlagToDisconnect(true, D_SessionResumed);
+    }
+
+    // and set erase flag
+    old->setFlagToErase(true);
+    this->markFlagged();
+
+    this->acceptBinary(client, binary);
+    this->sendReconnected(client);
+}
+
+
+void ClientManager::sendReconnected(Client& client) {
+    // client was in Lobby -- send message about being back in Lobby
+    if (client.getRoomId() == 0) {
+        this->sendToClient(client, Protocol::FRAME_RECN_LOBBY);
+    }
+    // never should happen, because room is destroyed together with erased player
+    else if (this->lobby.getRoom(client.getRoomId()) == nullptr || this->findOpponentOf(client) == this->clients.end()) {
+        logger->error("Room id [%d] of reconnected client [%s] doesn't exist.", client.getRoomId(), client.getNick().c_str());
+
+        this->lobby.destroyRoom(client.getRoomId(), client);
+        this->sendToClient(client, Protocol::FRAME_RECN_LOBBY);
+    }
+    // client was in game -- send message about being back in game
+    else {
+        // and send game status
+        this->sendToClient(client, this->composeMsgInGameRecn(client).view());
+        // inform opponent
+        this->sendToOpponentOf(client, Protocol::FRAME_OPN_RECN);
+    }
+
+    this->cli_reconnected += 1;
+    logger->info("Client [%s] on socket [%d] in room id [%d] reconnected.", client.getNick().c_str(), client.getSocket(), client.getRoomId());
+}
+
+
+/******************************************************************************
+ *
+ * 	Client, whose binary connection (or resumption) was accepted, talks
+ * 	binary protocol from the reply on. Text request does not switch binary
+ * 	client back.
+ *
+ */
+void ClientManager::acceptBinary(Client& client, const bool& binary) {
+    if (binary) {
+        client.setBinary(true);
     }
 }
 
@@ -189,7 +355,10 @@ void ClientManager::handleReconnection(Client& client, clientsIterator& clientOt
  *  After success 0 is returned, else -1.
  *
  */
-int ClientManager::requestConnect(Client& client, const std::string& nick, State state) {
+int ClientManager::connectClient(Client& client, const request& rqst, const bool& binary) {
+    std::string nick(rqst.value);
+    State state = client.getState();
+
     logger->trace("REQUEST connect VALUE [%s] socket [%d] nick [%s] state [%s].", nick.c_str(), client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
 
     int rv = 0;
@@ -212,12 +381,22 @@ int ClientManager::requestConnect(Client& client, const std::string& nick, State
         //  nick, which client chose could be used.. client stays connected for how long it is necessary,
         //  in order to choose different nick and without internet it might lead to being Lost or even Disconnected
         if (client.getStateLast() == New && (state == New || state == Pinged || state == Lost || state == Disconnected)) {
-            client.setNick(nick);
+            // the nick may belong to client on other shard (reconnection there)
+            int owner = this->shards->claimNick(nick, this->shardId);
+
+            if (owner != this->shardId) {
+                client.setShardToMove(owner);
+                return rv;
+            }
+
+            this->renameClient(client, nick);
             client.setState(Waiting);
             // set also state last, because it is somehow possible to get name without changing `State` properly...
             client.setStateLast(Waiting);
-            this->sendToClient(client, Protocol::SC_RESP_CONN);
-            this->sendToClient(client, Protocol::SC_IN_LOBBY);
+            this->bindToken(client, this->createToken(nick));
+            this->acceptBinary(client, binary);
+            this->sendToClient(client, this->composeMsgRespConn(client.getToken()).view());
+            this->sendToClient(client, Protocol::FRAME_IN_LOBBY);
         }
         else {
             rv = -1;
@@ -230,11 +409,11 @@ int ClientManager::requestConnect(Client& client, const std::string& nick, State
 
         // client does not have same ip address -- distant client
         if (clientOtherIpaddr == clientNone) {
-            this->sendToClient(client, Protocol::SC_NICK_USED);
+            this->sendToClient(client, Protocol::FRAME_NICK_USED);
         }
         // client has also same ip address -- local client
         else {
-            this->handleReconnection(client, clientOtherIpaddr, nick);
+            this->handleReconnection(client, clientOtherIpaddr, binary);
         }
     }
 
@@ -242,31 +421,146 @@ int ClientManager::requestConnect(Client& client, const std::string& nick, State
 }
 
 
-int ClientManager::requestReady(Client& client) {
+int ClientManager::requestConnect(Client& client, const request& rqst) {
+    return this->connectClient(client, rqst, false);
+}
+
+
+/******************************************************************************
+ *
+ * 	Same as connection request, but client will be talking binary protocol
+ * 	from now on, already the reply to this request is binary. Refused
+ * 	connection stays in text protocol.
+ *
+ */
+int ClientManager::requestConnBin(Client& client, const request& rqst) {
+    return this->connectClient(client, rqst, true);
+}
+
+
+/******************************************************************************
+ *
+ * 	Client presents token from response to its connection and gets back
+ * 	its nick, rating, state and game, whatever IP address it has now.
+ * 	Session is found in O(1) by token, or owner shard of session is asked.
+ * 	Client is told, when session is gone (erased), and has to connect
+ * 	with nick. Client with nick already can't take other session.
+ * 	Only session, whose connection stopped answering (Pinged, Lost or
+ * 	Disconnected), can be taken, otherwise nick is used.
+ *
+ */
+int ClientManager::resumeClient(Client& client, const request& rqst, const bool& binary) {
+    std::uint64_t token = 0;
+    State state = client.getState();
+
+    // parser let through only hexadecimal token of exact length
+    std::from_chars(rqst.value.data(), rqst.value.data() + rqst.value.length(), token, 16);
+
+    logger->trace("REQUEST resume socket [%d] nick [%s] state [%s].", client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
+
+    auto owner = this->findClientByToken(token);
+
+    if (owner == this->clients.end()) {
+        // the session may be on other shard
+        int shard = this->shards->findToken(token);
+
+        if (shard >= 0 && shard != this->shardId) {
+            client.setShardToMove(shard);
+        }
+        else {
+            this->sendToClient(client, Protocol::FRAME_SESS_GONE);
+        }
+
+        return 0;
+    }
+
+    // client resumes its session on the same connection
+    if (&*owner == &client) {
+        if (state == Pinged || state == Lost) {
+            client.setState(client.getStateLast());
+        }
+
+        this->acceptBinary(client, binary);
+        this->sendReconnected(client);
+        return 0;
+    }
+
+    if (client.getStateLast() != New || !client.getNick().empty()) {
+        return -1;
+    }
+
+    state = owner->getState();
+
+    // session is in use by connection, which answers, so the token is not of who holds the session
+    if (state != Pinged && state != Lost && state != Disconnected) {
+        logger->warning("Resume of session of client [%s] with ip [%s] on socket [%d] refused, its connection is alive.",
+                        owner->getNick().c_str(), owner->toStringIpAddr().c_str(), owner->getSocket());
+        this->sendToClient(client, Protocol::FRAME_NICK_USED);
+        return 0;
+    }
+
+    if (owner->getSocket() >= 0) {
+        logger->info("Session of client [%s] on socket [%d] not answering pings taken over by socket [%d].",
+                     owner->getNick().c_str(), owner->getSocket(), client.getSocket());
+    }
+
+    this->takeOverClient(client, owner, binary);
+
+    return 0;
+}
+
+
+int ClientManager::requestResume(Client& client, const request& rqst) {
+    return this->resumeClient(client, rqst, false);
+}
+
+
+int ClientManager::requestResumeBin(Client& client, const request& rqst) {
+    return this->resumeClient(client, rqst, true);
+}
+
+
+int ClientManager::requestReady(Client& client, const request&) {
     client.setState(Ready);
 
     return 0;
 }
 
 
-int ClientManager::requestMove(Client& client, const std::string& coordinates) {
+int ClientManager::requestMove(Client& client, const request& rqst) {
+    std::string coordinates(rqst.value);
+
     logger->trace("REQUEST move VALUE [%s] socket [%d] nick [%s] state [%s].", coordinates.c_str(), client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
 
     int rv = 0;
     int roomId = client.getRoomId();
 
-    // make move in room, where is client, who made this request
-    bool moved = this->lobby.moveInRoom(roomId, coordinates);
+    // Pinged client may be in Lobby, it cannot move there
+    if (roomId == 0) {
+        return -1;
+    }
+
+    // room, where is client, who made this request, is looked up once
+    RoomHnefatafl* room = this->lobby.getRoom(roomId);
+
+    if (room == nullptr) {
+        this->leaveOrphanedRoom(client);
+        return 0;
+    }
+
+    bool moved = room->processMove(coordinates);
 
     if (moved) {
-        // get clients in changed room (they already have swapped nicks)
-        std::string nickOnTurn = this->lobby.getNickofPlayerOnTurn(roomId);
-        std::string nickOnStand = this->lobby.getNickofPlayerOnStand(roomId);
-        auto onTurn = this->findClientByNick(nickOnTurn);
-        auto onStand = this->findClientByNick(nickOnStand);
+        // get clients in changed room (they already have swapped places)
+        auto onTurn = this->clients.find(room->getPlayerOnTurn());
+        auto onStand = this->clients.find(room->getPlayerOnStand());
 
-        // update their states (this is here, because i can't have any link in class RoomHnefatafl
-        // to the clients, except for their nicks, because of iterator magic
+        if (onTurn == this->clients.end() || onStand == this->clients.end()) {
+            this->leaveOrphanedRoom(client);
+            return 0;
+        }
+
+        // update their states (room knows only handles of the clients)
 
         // check if opponent (now is on turn) is Pinged/Lost/Disconnected
         if (onTurn->getState() == Pinged || onTurn->getState() == Lost || onTurn->getState() == Disconnected) {
@@ -281,14 +575,14 @@ int ClientManager::requestMove(Client& client, const std::string& coordinates) {
         onStand->setState(PlayingOnStand);
 
         // after successful move, inform requesting client and the opponent, where client moved
-        this->sendToClient(*onStand, Protocol::SC_MV_VALID);
-        this->sendToClient(*onTurn, Protocol::SC_OPN_MOVE + Protocol::OP_INI + coordinates);
+        this->sendToClient(*onStand, Protocol::FRAME_MV_VALID);
+        this->sendToClient(*onTurn, FrameBuilder().add(Protocol::SC_OPN_MOVE).add(Protocol::OP_INI).add(coordinates).close().view());
 
         // when game is over, send clients to lobby and destroy their room
-        if (this->lobby.getRoomStatus(roomId) == Gameover) {
+        if (room->getGameStatus() == Gameover) {
             // if the game is over, the winner did last move, so looser is now on turn
-            this->sendToClient(*onTurn, Protocol::SC_GO_LOSS);
-            this->sendToClient(*onStand, Protocol::SC_GO_WIN);
+            this->sendToClient(*onTurn, Protocol::FRAME_GO_LOSS);
+            this->sendToClient(*onStand, Protocol::FRAME_GO_WIN);
 
             // finally destroy the finished game room
             this->lobby.destroyRoom(roomId, *onTurn, *onStand);
@@ -301,32 +595,45 @@ int ClientManager::requestMove(Client& client, const std::string& coordinates) {
 }
 
 
-int ClientManager::requestLeave(Client& client) {
+int ClientManager::requestLeave(Client& client, const request&) {
+    // Pinged client may be in Lobby, there is no game to leave
+    if (client.getRoomId() == 0) {
+        return -1;
+    }
+
     // reply client with leave game success
-    this->sendToClient(client, Protocol::SC_RESP_LEAVE);
+    this->sendToClient(client, Protocol::FRAME_RESP_LEAVE);
     // notify opponent about client Leaving and move them to Lobby
-    this->sendToOpponentOf(client, Protocol::SC_OPN_LEAVE);
+    this->sendToOpponentOf(client, Protocol::FRAME_OPN_LEAVE);
     // destroy their game, because one player does not want to play anymore
-    auto opponent = this->findClientByNick(this->lobby.getOpponentOf(client));
-    this->lobby.destroyRoom(client.getRoomId(), client, *opponent);
+    auto opponent = this->findOpponentOf(client);
+
+    if (opponent == this->clients.end()) {
+        this->lobby.destroyRoom(client.getRoomId(), client);
+    }
+    else {
+        this->lobby.destroyRoom(client.getRoomId(), client, *opponent);
+    }
 
     return 0;
 }
 
 
-int ClientManager::requestPing(Client& client, State state) {
+int ClientManager::requestPing(Client& client, const request&) {
+    State state = client.getState();
+
     logger->trace("PING request socket [%d] nick [%s] state [%s].", client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
 
     if (state == Pinged || state == Lost) {
         client.setState(client.getStateLast());
     }
-    this->sendToClient(client, Protocol::OP_PONG);
+    this->sendToClient(client, Protocol::FRAME_PONG);
 
     return 0;
 }
 
 
-int ClientManager::requestPong(Client& client) {
+int ClientManager::requestPong(Client& client, const request&) {
     logger->trace("PONG request socket [%d] nick [%s] state [%s].", client.getSocket(), client.getNick().c_str(), client.toStringState().c_str());
 
     client.setState(client.getStateLast());
@@ -335,9 +642,22 @@ int ClientManager::requestPong(Client& client) {
 }
 
 
-int ClientManager::requestChat(Client& client, const std::string& _msg) {
-    std::string msg = Protocol::OP_CHAT + Protocol::OP_INI + _msg;
-    this->sendToOpponentOf(client, msg);
+int ClientManager::requestChat(Client& client, const request& rqst) {
+    FrameBuilder frame;
+
+    // Pinged client may be in Lobby, there is no opponent to chat with
+    if (client.getRoomId() == 0) {
+        return -1;
+    }
+
+    frame.add(Protocol::OP_CHAT).add(Protocol::OP_INI).add(rqst.value).close();
+
+    // message longer than any reply is not sent to opponent
+    if (frame.isOverflown()) {
+        return -1;
+    }
+
+    this->sendToOpponentOf(client, frame.view());
 
     return 0;
 }
@@ -353,34 +673,174 @@ void ClientManager::startGame(const int& id, Client& cli1, Client& cli2) {
     cli2.setState(PlayingOnStand);
 
     // send message to players, who just started playing
-    this->sendToClient(cli1, this->composeMsgInGame(Protocol::SC_TURN_YOU, cli2.getNick()));
-    this->sendToClient(cli2, this->composeMsgInGame(Protocol::SC_TURN_OPN, cli1.getNick()));
+    this->sendToClient(cli1, this->composeMsgInGame(Protocol::SC_TURN_YOU, cli2.getNick()).view());
+    this->sendToClient(cli2, this->composeMsgInGame(Protocol::SC_TURN_OPN, cli1.getNick()).view());
+}
+
+
+void ClientManager::pairClients(clientsIterator& cli1, clientsIterator& cli2) {
+    // create game for them
+    int roomId = this->lobby.createRoom(*cli1, this->clients.handleOf(*cli1), *cli2, this->clients.handleOf(*cli2));
+    // initialize new room (both are not Ready anymore)
+    this->startGame(roomId, *cli1, *cli2);
+}
+
+
+bool ClientManager::isWithinWindow(const clientsIterator& other, const int& rating, const long long& window) {
+    return other != this->clients.end() && std::abs(this->clients.getTable().getRating(other.getIndex()) - rating) <= window;
+}
+
+
+/******************************************************************************
+ *
+ * 	Only head of bucket is looked at, so the lookup does not depend on count
+ * 	of waiting clients -- the rest of a bucket only holds ratings of its
+ * 	narrow range. Lowest and highest bucket take all ratings beyond, so they
+ * 	are walked, until someone within the window is found.
+ *
+ */
+clientsIterator ClientManager::findInBucket(const int& bucket, const int& rating, const long long& window) {
+    auto candidate = this->clients.firstReady(bucket);
+
+    if (bucket == 0 || bucket == ClientTable::BUCKETS - 1) {
+        while (candidate != this->clients.end() && !this->isWithinWindow(candidate, rating, window)) {
+            candidate = this->clients.nextReady(candidate);
+        }
+    }
+
+    return this->isWithinWindow(candidate, rating, window) ? candidate : this->clients.end();
+}
+
+
+/******************************************************************************
+ *
+ * 	Opponent is the next one in the same rating bucket, or first one
+ * 	in the nearest bucket, whose rating differs by no more than window.
+ * 	The window widens with time the client waits, so nobody waits forever
+ * 	for equal opponent. Buckets only tell, where to look, the actual
+ * 	difference of ratings decides. Only heads of few buckets are looked
+ * 	at, however many clients wait (bucket of the client and the lowest
+ * 	and highest one are walked, see findInBucket()).
+ *
+ */
+clientsIterator ClientManager::findRatedOpponent(clientsIterator& player, const long long& now) {
+    const ClientTable& table = this->clients.getTable();
+    int bucket = table.getBucket(player.getIndex());
+    int rating = table.getRating(player.getIndex());
+    long long window = RATING_WINDOW + RATING_WIDENING * ((now - table.getReadySince(player.getIndex())) / 1000);
+
+    auto none = this->clients.end();
+    auto opponent = this->clients.nextReady(player);
+
+    while (opponent != none && !this->isWithinWindow(opponent, rating, window)) {
+        opponent = this->clients.nextReady(opponent);
+    }
+
+    // bucket at given distance can hold rating within window, only if the distance less one is within it
+    for (int distance = 1; opponent == none && (distance - 1) * ClientTable::BUCKET_WIDTH < window && distance < ClientTable::BUCKETS; ++distance) {
+        auto lower = bucket - distance >= 0 ? this->findInBucket(bucket - distance, rating, window) : none;
+        auto upper = bucket + distance < ClientTable::BUCKETS ? this->findInBucket(bucket + distance, rating, window) : none;
+
+        // from two buckets at the same distance, the one waiting longer is taken
+        if (lower != none && (upper == none || table.getReadySince(lower.getIndex()) <= table.getReadySince(upper.getIndex()))) {
+            opponent = lower;
+        }
+        else {
+            opponent = upper;
+        }
+    }
+
+    return opponent;
+}
+
+
+/******************************************************************************
+ *
+ * 	Client without opponent within the window stays in queue and the next
+ * 	one in its bucket tries. Client, who came later, has narrower window,
+ * 	so it is never paired with one, who was skipped before. Bucket is
+ * 	narrower than the window, so in most buckets the skipped client is
+ * 	alone there -- only the lowest and highest bucket really are walked.
+ *
+ */
+clientsIterator ClientManager::moveRatedClientsToPlay() {
+    long long now = ClientTable::now();
+    auto lonely = this->clients.end();
+
+    for (int bucket = 0; bucket < ClientTable::BUCKETS; ++bucket) {
+        auto player = this->clients.firstReady(bucket);
+
+        while (player != this->clients.end()) {
+            auto opponent = this->findRatedOpponent(player, now);
+            auto next = this->clients.nextReady(player);
+
+            if (opponent == this->clients.end()) {
+                lonely = player;
+                player = next;
+                continue;
+            }
+
+            // no free room, so everybody keeps waiting in queue
+            if (this->lobby.isFull()) {
+                return this->clients.end();
+            }
+
+            // paired clients leave the queue, so the next one is found before
+            if (next == opponent) {
+                next = this->clients.nextReady(next);
+            }
+
+            this->pairClients(player, opponent);
+
+            player = next;
+        }
+    }
+
+    return lonely;
 }
 
 
 // ----- COMPOSERS
 
 
-std::string ClientManager::composeMsgInGame(const std::string& turn, const std::string& nick) {
-    // eg. {ig,ty,on:nick12}
-    return Protocol::SC_IN_GAME + Protocol::OP_SEP + turn + Protocol::OP_SEP
-         + Protocol::SC_OPN_NAME + Protocol::OP_INI + nick;
+FrameBuilder ClientManager::composeMsgRespConn(const std::uint64_t& token) {
+    FrameBuilder frame;
+    char hex[Protocol::TOKEN_LEN + 1];
+
+    // eg. {rc:0123456789abcdef}
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) token);
+
+    frame.add(Protocol::SC_RESP_CONN).add(Protocol::OP_INI).add(std::string_view(hex, Protocol::TOKEN_LEN))
+         .close();
+
+    return frame;
 }
 
 
-std::string ClientManager::composeMsgInGameRecn(Client& client) {
-    // {rr,ig,ty,op:onick,pf:0..9}
-    return Protocol::SC_RESP_RECN + Protocol::OP_SEP
-           + Protocol::SC_IN_GAME + Protocol::OP_SEP
-           + (client.getState() == PlayingOnTurn ? Protocol::SC_TURN_YOU : Protocol::SC_TURN_OPN) + Protocol::OP_SEP
-           + Protocol::SC_OPN_NAME + Protocol::OP_INI + this->lobby.getOpponentOf(client) + Protocol::OP_SEP
-           + Protocol::SC_PLAYFIELD + Protocol::OP_INI + this->lobby.getPlayfieldString(client.getRoomId());
+FrameBuilder ClientManager::composeMsgInGame(const std::string& turn, const std::string& nick) {
+    FrameBuilder frame;
+
+    // eg. {ig,ty,on:nick12}
+    frame.add(Protocol::SC_IN_GAME).next(turn)
+         .next(Protocol::SC_OPN_NAME).add(Protocol::OP_INI).add(nick)
+         .close();
+
+    return frame;
 }
 
 
-std::string ClientManager::composeMsgInLobbyRecn() {
-    // {rr,il}
-    return Protocol::SC_RESP_RECN + Protocol::OP_SEP + Protocol::SC_IN_LOBBY;
+FrameBuilder ClientManager::composeMsgInGameRecn(Client& client) {
+    FrameBuilder frame;
+
+    // {rr,ig,ty,op:onick,pf:0..9}
+    frame.add(Protocol::SC_RESP_RECN)
+         .next(Protocol::SC_IN_GAME)
+         .next(client.getState() == PlayingOnTurn ? Protocol::SC_TURN_YOU : Protocol::SC_TURN_OPN)
+         .next(Protocol::SC_OPN_NAME).add(Protocol::OP_INI).add(this->findOpponentOf(client)->getNick())
+         .next(Protocol::SC_PLAYFIELD).add(Protocol::OP_INI).add(this->lobby.getRoom(client.getRoomId())->getPlayfieldString())
+         .close();
+
+    return frame;
 }
 
 
@@ -395,49 +855,67 @@ std::string ClientManager::composeMsgInLobbyRecn() {
 
 /******************************************************************************
  *
- *  Takes request from client and parses individual elements.
- *  Eg. from "c:nick" it makes "c" and "nick".
- *  Then sends this for individual processing, which if fails,
- *  breaks the loop and -1 is returned, else 0, when success.
+ *  Takes requests parsed from client's message and sends them for individual
+ *  processing, which if fails, breaks the loop and -1 is returned, else 0,
+ *  when success. If client has to be handed over to other shard, 1 is returned
+ *  and data contain requests, which were not served.
  *
  */
 int ClientManager::process(Client& client, clientData& data) {
     int processed = 0;
 
-    request rqst = request();
-    std::smatch match;
-
-    // loop over every data in rqst queue {...}
-    while (!data.empty()) {
-        // parse every key-value from data R("[^:]+")
-        while (regex_search(data.front(), match, Protocol::rgx_key_value)) {
-            // insert it to rqst queue
-            rqst.emplace(match.str());
-            // process next part of string in data
-            data.front() = match.suffix();
-        }
-
-        // pop just processed data
-        data.pop();
-
+    for (std::size_t i = 0; i < data.size(); ++i) {
         // finally process client's request
-        if (this->routeRequest(client, rqst) != 0) {
+        if (this->routeRequest(client, data[i]) != 0) {
             // if request couldn't be processed, stop and set return value to -1 (failure)
             // eg. if client sent message in valid format, but it is not valid in terms
             // of server logic or game logic (sbdy is h4ck1ng w/ t3ln3t..)
             processed = -1;
             break;
         }
+
+        // client belongs to other shard, so leave this request and the rest for it
+        if (client.getShardToMove() >= 0) {
+            data.erase(data.begin(), data.begin() + i);
+            processed = 1;
+            break;
+        }
     }
 
     return processed;
 }
 
 
-void ClientManager::createClient(const std::string& ip, const int& sock) {
+clientsIterator ClientManager::createClient(const std::uint32_t& ip, const int& sock) {
     this->cli_connected += 1;
 
-    this->clients.emplace_back(ip, sock);
+    auto client = this->clients.emplace(ip, sock);
+
+    // remember slot of client by socket and by timer
+    this->indexClient(client);
+
+    return client;
+}
+
+
+clientsIterator ClientManager::adoptClient(const Client& client, const std::string& nick, const long long& readySince) {
+    auto adopted = this->clients.insert(client);
+
+    // nick and time of becoming Ready are kept by slot map, so they are given to client in its new slot
+    adopted->setNick(nick);
+    this->clients.setReadySince(*adopted, readySince);
+
+    // remember slot of client by socket and by timer
+    this->indexClient(adopted);
+
+    return adopted;
+}
+
+
+void ClientManager::detachClient(clientsIterator& client) {
+    this->unindexClient(*client);
+
+    this->clients.erase(client);
 }
 
 
@@ -447,115 +925,170 @@ clientsIterator ClientManager::eraseClient(clientsIterator& client) {
         // before erasing check if client is in game.. if yes, destroy the game
         if (client->getRoomId() != 0 && (client->getStateLast() == PlayingOnTurn || client->getStateLast() == PlayingOnStand)) {
             // get opponent of client, who is going to be erased
-            auto opponent = this->findClientByNick(this->lobby.getOpponentOf(*client));
+            auto opponent = this->findOpponentOf(*client);
 
-            // if opponent is not also disconnected, send the message
-            if (opponent->getState() != Disconnected) {
-                // send message to opponent, that the client can't reconnect anymore
-                this->sendToClient(*opponent, Protocol::SC_OPN_GONE);
-                this->sendToClient(*client, Protocol::SC_IN_LOBBY);
+            if (opponent == this->clients.end()) {
+                this->lobby.destroyRoom(client->getRoomId(), *client);
             }
+            else {
+                // if opponent is not also disconnected, send the message
+                if (opponent->getState() != Disconnected) {
+                    // send message to opponent, that the client can't reconnect anymore
+                    this->sendToClient(*opponent, Protocol::FRAME_OPN_GONE);
+                    this->sendToClient(*client, Protocol::FRAME_IN_LOBBY);
+                }
 
-            // destroy their room
-            this->lobby.destroyRoom(client->getRoomId(), *client, *opponent);
+                // destroy their room
+                this->lobby.destroyRoom(client->getRoomId(), *client, *opponent);
+            }
         }
 
+        // nick is free for everybody again, session is gone
+        this->shards->releaseNick(client->getNick(), this->shardId);
+        this->shards->releaseToken(client->getToken());
+
         logger->info("Client [%s] completely disconnected.", client->getNick().c_str());
     }
 
+    this->unindexClient(*client);
+
     // finally erase client, who have been disconnected for long time
     return this->clients.erase(client);
 }
 
 
 void ClientManager::eraseLongestDisconnectedClient() {
-    // TO-DO longterm: how to write this with <algorithm>
-
-    auto longestDiscCli = this->clients.end();
-
-    // find first disconnected client
-    for (auto cli = this->clients.begin(); cli != this->clients.end(); ++cli) {
-        if (cli->getState() == Disconnected) {
-            longestDiscCli = cli;
-            break;
-        }
-    }
-
-    // check other clients, if they are disconnected for longer time
-    for (auto cli = longestDiscCli + 1; cli != clients.end(); ++cli) {
-        if (cli->getState() == Disconnected && cli->getInaccessCount() < longestDiscCli->getInaccessCount()) {
-            longestDiscCli = cli;
-        }
-    }
+    // Disconnected clients are queued, longest disconnected first
+    auto longestDiscCli = this->clients.firstDisconnected();
 
     // always should be true, because it is used after isDisconnectedClient(),
     // thus there must be client, who is Disconnected
     if (longestDiscCli != this->clients.end()) {
-        this->clients.erase(longestDiscCli);
+        // same as when waiting for reconnection is over, so opponent and room are not left behind
+        this->eraseClient(longestDiscCli);
     }
 }
 
 
 /******************************************************************************
  *
- * 	On successful send of message returns count of sent bytes, on failure returns -1.
+ * 	Queue message to client's output. It is sent at the end of the tick together
+ * 	with everything else the client got meanwhile, so one request costs one send.
+ * 	Client, whose output grows over the limit, does not read and is disconnected
+ * 	instead of blocking the server. Returns length of queued message, or -1.
  *
  */
-int ClientManager::sendToClient(Client& client, const std::string& _msg) {
-    // close message to protocol header and footer
-    std::string msg = Protocol::OP_SOH + _msg + Protocol::OP_EOT;
-
-    int msg_len = msg.length();
-    // + 1 for null terminating char
-    char buff[msg_len + 1];
-    char* p_buff = buff;
-
-    // fill buffer with the message
-    strcpy(buff, msg.c_str());
-
-    int sent = 0;
-    int sent_total = 0;
-    int failed_send_count = 3;
+int ClientManager::sendToClient(Client& client, const std::string_view& frame) {
+    int sent_total = -1;
 
     if (client.getSocket() < 0) {
-        logger->warning("Sending SKIPPED, message [%s] to client [%s] on socket [%d].", buff, client.getNick().c_str(), client.getSocket());
-        failed_send_count = 0;
+        logger->warning("Sending SKIPPED, message [%.*s] to client [%s] on socket [%d].", (int) frame.length(), frame.data(), client.getNick().c_str(), client.getSocket());
     }
-    else {
-        logger->trace("Sending message [%s] to client [%s] on socket [%d].", buff, client.getNick().c_str(), client.getSocket());
+    // frame did not fit to frame builder, so this is a bug of server
+    else if (frame.empty()) {
+        logger->error("Sending SKIPPED, message to client [%s] on socket [%d] is longer than [%d] bytes.", client.getNick().c_str(), client.getSocket(), Protocol::LONGEST_REPLY);
+    }
+    // nothing more for client, who is going to be disconnected
+    else if (client.getFlagToDisconnect()) {
+        logger->trace("Sending SKIPPED, message [%.*s] to client [%s] on socket [%d] is going to be disconnected.", (int) frame.length(), frame.data(), client.getNick().c_str(), client.getSocket());
     }
+    else {
+        logger->trace("Sending message [%.*s] to client [%s] on socket [%d].", (int) frame.length(), frame.data(), client.getNick().c_str(), client.getSocket());
+
+        std::array<char, Protocol::LONGEST_REPLY> message;
+        std::string_view encoded = frame;
+
+        if (client.isBinary()) {
+            encoded = std::string_view(message.data(), encodeFrame(frame, message.data()));
+
+            // every reply has binary form, so this is a bug of server
+            if (encoded.empty()) {
+                logger->error("Sending SKIPPED, message [%.*s] to client [%s] on socket [%d] has no binary form.", (int) frame.length(), frame.data(), client.getNick().c_str(), client.getSocket());
+                return sent_total;
+            }
+        }
+
+        // client with non-empty output is already dirty, or waits for writable socket
+        if (client.getOutbox().isEmpty()) {
+            this->dirty.push_back(client.getSocket());
+        }
+
+        client.getOutbox().push(encoded);
 
-    // send the message
-    while (msg_len > 0 && failed_send_count > 0) {
-        sent = send(client.getSocket(), p_buff, msg_len * sizeof(char), 0);
+        if (client.getOutbox().getLength() > this->outLimit) {
+            logger->warning("Output of client [%s] on socket [%d] is over [%d] bytes.", client.getNick().c_str(), client.getSocket(), this->outLimit);
 
-        if (sent > 0) {
-            sent_total += sent;
-            p_buff += sent;
-            msg_len -= sent;
+            client.setFlagToDisconnect(true, D_OutputOverflow);
+            this->markFlagged();
         }
         else {
-            --failed_send_count;
+            sent_total = frame.length();
         }
     }
 
-    // increment even when send() was not finished
-    this->bytesSend += sent_total;
+    return sent_total;
+}
 
-    // if was unable to send message to client 3 times
-    if (failed_send_count == 0) {
-        sent_total = -1;
+
+/******************************************************************************
+ *
+ * 	Socket takes as much as it can, the rest is flushed, when it is writable again.
+ * 	Client with broken connection is disconnected.
+ *
+ */
+int ClientManager::flushClient(Client& client) {
+    int sent = this->reactor->flush(client.getSocket(), client.getOutbox());
+
+    // count only sent (or taken by reactor) bytes
+    if (sent > 0) {
+        this->bytesSend += sent;
+    }
+    else if (sent < 0 && !client.getFlagToDisconnect()) {
+        client.setFlagToDisconnect(true, D_SendingFailed);
+        this->markFlagged();
     }
 
-    return sent_total;
+    return sent;
+}
+
+
+/******************************************************************************
+ *
+ * 	Client might have been closed or handed over since its output was queued,
+ * 	so it is looked up by socket again.
+ *
+ */
+void ClientManager::flushDirtyClients() {
+    for (const auto& sock : this->dirty) {
+        auto client = this->findClientBySocket(sock);
+
+        if (client != this->clients.end() && !client->getOutbox().isEmpty()) {
+            this->flushClient(*client);
+        }
+    }
+
+    this->dirty.clear();
+}
+
+
+/******************************************************************************
+ *
+ * 	Never should happen, because room is destroyed, when instance of player
+ * 	is erased. Client, whose opponent is gone anyway, is told so and is back
+ * 	in Lobby, instead of playing against nobody.
+ *
+ */
+void ClientManager::leaveOrphanedRoom(Client& client) {
+    logger->error("Opponent of client [%s] in room id [%d] doesn't exist.", client.getNick().c_str(), client.getRoomId());
+
+    this->sendToClient(client, Protocol::FRAME_OPN_GONE);
+    this->lobby.destroyRoom(client.getRoomId(), client);
 }
 
 
-void ClientManager::sendToOpponentOf(Client& client, const std::string& msg) {
-    // get nick of opponent
-    std::string nick_opponent = this->lobby.getOpponentOf(client);
+void ClientManager::sendToOpponentOf(Client& client, const std::string_view& frame) {
     // find instance of opponent
-    auto opponent = this->findClientByNick(nick_opponent);
+    auto opponent = this->findOpponentOf(client);
 
     // never should get here, because when instance of client is erased, the game room is destroyed
     if (opponent == this->clients.end()) {
@@ -567,19 +1100,57 @@ void ClientManager::sendToOpponentOf(Client& client, const std::string& msg) {
     }
     // send message to opponent
     else {
-        this->sendToClient(*opponent, msg);
+        this->sendToClient(*opponent, frame);
     }
 }
 
 
+clientsIterator ClientManager::findClientBySocket(const int& sock) {
+    auto wanted = this->clients.end();
+
+    if (sock >= 0 && sock < (int) this->socketIndex.size() && this->socketIndex[sock] >= 0) {
+        wanted = this->clients.at(this->socketIndex[sock]);
+    }
+
+    return wanted;
+}
+
+
+clientsIterator ClientManager::findClientByTimerKey(const int& key) {
+    auto wanted = this->clients.end();
+    auto position = this->timerIndex.find(key);
+
+    if (position != this->timerIndex.end()) {
+        wanted = this->clients.at(position->second);
+    }
+
+    return wanted;
+}
+
+
+clientsIterator ClientManager::findOpponentOf(const Client& client) {
+    return this->clients.find(this->lobby.getOpponentOf(client, this->clients.handleOf(client)));
+}
+
+
 clientsIterator ClientManager::findClientByNick(const std::string& nick) {
     auto wanted = this->clients.end();
+    int position = this->nickIndex.find(nick);
 
-    for (auto cli = clients.begin(); cli != clients.end(); ++cli) {
-        if (cli->getNick() == nick) {
-            wanted = cli;
-            break;
-        }
+    if (position >= 0) {
+        wanted = this->clients.at(position);
+    }
+
+    return wanted;
+}
+
+
+clientsIterator ClientManager::findClientByToken(const std::uint64_t& token) {
+    auto wanted = this->clients.end();
+    auto position = this->tokenIndex.find(token);
+
+    if (position != this->tokenIndex.end()) {
+        wanted = this->clients.at(position->second);
     }
 
     return wanted;
@@ -600,14 +1171,16 @@ clientsIterator ClientManager::findClientByNick(const std::string& nick) {
 //}
 
 
-clientsIterator ClientManager::findClientByNickAndIp(const std::string& nick, const std::string& ip) {
-    auto wanted = this->clients.end();
+/******************************************************************************
+ *
+ * 	Nick is unique in shard, so client with the nick is the only candidate.
+ *
+ */
+clientsIterator ClientManager::findClientByNickAndIp(const std::string& nick, const std::uint32_t& ip) {
+    auto wanted = this->findClientByNick(nick);
 
-    for (auto cli = clients.begin(); cli != clients.end(); ++cli) {
-        if (cli->getNick() == nick && cli->getIpAddr() == ip) {
-            wanted = cli;
-            break;
-        }
+    if (wanted != this->clients.end() && wanted->getIpAddr() != ip) {
+        wanted = this->clients.end();
     }
 
     return wanted;
@@ -615,46 +1188,57 @@ clientsIterator ClientManager::findClientByNickAndIp(const std::string& nick, co
 
 
 bool ClientManager::isDisconnectedClient() {
-    bool isDiscCli = false;
+    return this->clients.firstDisconnected() != this->clients.end();
+}
 
-    for (auto & client : this->clients) {
-        if (client.getState() == Disconnected) {
-            isDiscCli = true;
-            break;
-        }
-    }
 
-    return isDiscCli;
+void ClientManager::markFlagged() {
+    this->flagged = true;
+}
+
+
+bool ClientManager::takeFlagged() {
+    bool wasFlagged = this->flagged;
+    this->flagged = false;
+
+    return wasFlagged;
 }
 
 
 /******************************************************************************
  *
- * 	Finds every two Ready clients and sends them to play a game in time O(n).
+ * 	Pairs Ready clients from head of ready queue, longest waiting ones first,
+ * 	so cost follows count of Ready clients, not count of all clients.
+ * 	Clients leave the queue by getting to game. In rated matchmaking they
+ * 	are paired by rating instead. Returns Ready client, who was left
+ * 	without opponent, or end of slots.
  *
  */
-void ClientManager::moveReadyClientsToPlay() {
-    int roomId = 0;
-
-    for (auto cli1 = this->clients.begin(); cli1 != this->clients.end(); ++cli1) {
-        // first Waiting client found
-        if (cli1->getState() == Ready) {
-
-            for (auto cli2 = cli1 + 1; cli2 != this->clients.end(); ++cli2) {
-                // second Waiting client found
-                if (cli2->getState() == Ready) {
-                    // create game for them
-                    roomId = this->lobby.createRoom(cli1->getNick(), cli2->getNick());
-                    // initialize new room
-                    this->startGame(roomId, *cli1, *cli2);
-
-                    // continue searching from position next to second client
-                    cli1 = cli2;
-                    break;
-                }
-            }
+clientsIterator ClientManager::moveReadyClientsToPlay() {
+    if (this->rated) {
+        return this->moveRatedClientsToPlay();
+    }
+
+    auto lonely = this->clients.firstReady(0);
+
+    while (lonely != this->clients.end()) {
+        auto opponent = this->clients.nextReady(lonely);
+
+        if (opponent == this->clients.end()) {
+            break;
+        }
+
+        // no free room, so everybody keeps waiting in queue
+        if (this->lobby.isFull()) {
+            return this->clients.end();
         }
+
+        this->pairClients(lonely, opponent);
+
+        lonely = this->clients.firstReady(0);
     }
+
+    return lonely;
 }
 
 
@@ -687,10 +1271,10 @@ const int& ClientManager::getRoomsTotal() const {
 
 /******************************************************************************
  *
- * 	Get access to vector of clients, so Server is able to update them.
+ * 	Get access to clients, so Server is able to update them.
  *
  */
-std::vector<Client>& ClientManager::getVectorOfClients() {
+ClientSlots& ClientManager::getClients() {
     return this->clients;
 }
 
@@ -698,6 +1282,30 @@ std::vector<Client>& ClientManager::getVectorOfClients() {
 // ----- PRINTERS
 
 
+void ClientManager::setReactor(Reactor* r) {
+    this->reactor = r;
+}
+
+
+void ClientManager::setShards(Shards* s, const int& id) {
+    this->shards = s;
+    this->shardId = id;
+}
+
+void ClientManager::setOutLimit(const int& limit) {
+    this->outLimit = limit;
+}
+
+void ClientManager::setRated(const bool& value) {
+    this->rated = value;
+    this->clients.setRated(value);
+}
+
+void ClientManager::setMaxRooms(const int& max) {
+    this->lobby.setMaxRooms(max);
+}
+
+
 void ClientManager::setDisconnected(clientsIterator& client) {
     this->cli_disconnected += 1;
     client->setState(Disconnected);
@@ -705,6 +1313,11 @@ void ClientManager::setDisconnected(clientsIterator& client) {
 
 
 void ClientManager::setBadSocket(clientsIterator& client, const int& badsock) {
+    // client is not reachable by the old socket anymore
+    if (client->getSocket() >= 0) {
+        this->socketIndex[client->getSocket()] = -1;
+    }
+
     client->setSocket(badsock);
 }
 
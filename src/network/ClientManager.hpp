@@ -1,23 +1,72 @@
 #ifndef CLIENTMANAGER_HPP
 #define CLIENTMANAGER_HPP
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 #include "../game/Lobby.hpp"
 #include "Client.hpp"
+#include "ClientSlots.hpp"
+#include "FrameBuilder.hpp"
+#include "NickIndex.hpp"
 #include "protocol.hpp"
+#include "Reactor.hpp"
+#include "Shards.hpp"
 
 
-using clientsIterator = std::vector<Client>::iterator;
+using clientsIterator = ClientSlots::iterator;
 
 class ClientManager {
 private:
 
+    /** Handler of one request. */
+    using Handler = int (ClientManager::*)(Client&, const request&);
+
+    /** Count of opcodes of requests. */
+    constexpr static const int OPCODES = O_Ok + 1;
+    /** Count of client's states. */
+    constexpr static const int STATES = Disconnected + 1;
+    /** Widest difference of ratings of opponents, when client just became Ready (rated matchmaking). */
+    constexpr static const int RATING_WINDOW = 100;
+    /** Rating points, by which the window widens every second of waiting. */
+    constexpr static const int RATING_WIDENING = 25;
+    /** Handler of request by its opcode and state of client, who sent it (nullptr == violation of protocol). */
+    static const Handler ROUTES[OPCODES][STATES];
+
     /** Lobby takes care of waiting and playing clients. */
     Lobby lobby;
 
-    /** Vector of clients. */
-    std::vector<Client> clients;
+    /** Event loop backend, which sends messages to sockets. */
+    Reactor* reactor;
+
+    /** All shards, for nicks owned by other shards. */
+    Shards* shards;
+    /** Id of shard of this manager. */
+    int shardId;
+
+    /** Clients in slots, which are kept for whole life of client. */
+    ClientSlots clients;
+    /** Slot of client indexed by client's socket (-1 == no client). */
+    std::vector<int> socketIndex;
+    /** Slot of client by key of client's heartbeat timer. */
+    std::unordered_map<int, int> timerIndex;
+    /** Slot of client by client's nick (clients without nick are not there). */
+    NickIndex nickIndex;
+    /** Slot of client by session token (clients without token are not there). */
+    std::unordered_map<std::uint64_t, int> tokenIndex;
+    /** Key for heartbeat timer of next created or adopted client. */
+    int nextTimerKey;
+
+    /** Some client was flagged to disconnect or to erase since last check. */
+    bool flagged;
+    /** Ready clients are paired by rating, instead of by time of becoming Ready. */
+    bool rated;
+
+    /** High-water mark of client's output in bytes. Client, who does not read, is disconnected over it. */
+    int outLimit;
+    /** Sockets of clients, whose output was queued since last flush. Output is flushed once per tick. */
+    std::vector<int> dirty;
 
     /** Increased after creating new client instance. */
     int cli_connected;
@@ -30,30 +79,64 @@ private:
     /** Total sent bytes. ClientManager is only sending. */
     int bytesSend;
 
-    /** Route parsed client's request. */
-    int routeRequest(Client&, request&);
+    /** Remember slot of new client by its socket and nick and give it timer key. */
+    void indexClient(clientsIterator&);
+    /** Forget client, who is going to be erased, in all indexes. */
+    void unindexClient(const Client&);
+    /** Set nick of client and keep nick index consistent. */
+    void renameClient(Client&, const std::string&);
+    /** Set session token of client and keep token index consistent. */
+    void bindToken(Client&, const std::uint64_t&);
+    /** Create new session token, unique among all shards, for client with given nick. */
+    std::uint64_t createToken(const std::string&);
 
-    /** Handle reconnection. */
-    void handleReconnection(Client&, clientsIterator&, const std::string&);
+    /** Route parsed client's request. */
+    int routeRequest(Client&, const request&);
+
+    /** Handle reconnection (in binary protocol, if it is true). */
+    void handleReconnection(Client&, clientsIterator&, const bool&);
+    /** Move session of old instance of client to new one and erase the old one. */
+    void takeOverClient(Client&, clientsIterator&, const bool&);
+    /** Tell reconnected client, where it is back, and its opponent, that it is back. */
+    void sendReconnected(Client&);
+    /** Switch client to binary protocol, if its accepted request was binary. */
+    void acceptBinary(Client&, const bool&);
+    /** Connect client by nick (in binary protocol, if it is true). */
+    int connectClient(Client&, const request&, const bool&);
+    /** Resume session of client by token (in binary protocol, if it is true). */
+    int resumeClient(Client&, const request&, const bool&);
 
     // requests
-    int requestConnect(Client&, const std::string&, State);
-    int requestReady(Client&);
-    int requestMove(Client&, const std::string&);
-    int requestLeave(Client&);
-    int requestPing(Client&, State);
-    int requestPong(Client&);
-    int requestChat(Client&, const std::string&);
+    int requestConnect(Client&, const request&);
+    int requestConnBin(Client&, const request&);
+    int requestResume(Client&, const request&);
+    int requestResumeBin(Client&, const request&);
+    int requestReady(Client&, const request&);
+    int requestMove(Client&, const request&);
+    int requestLeave(Client&, const request&);
+    int requestPing(Client&, const request&);
+    int requestPong(Client&, const request&);
+    int requestChat(Client&, const request&);
 
     /** Sets Id and State to clients, who starts to play.. */
     void startGame(const int&, Client& cli1, Client& cli2);
-
+    /** Create room for two Ready clients and start their game. */
+    void pairClients(clientsIterator&, clientsIterator&);
+    /** Rating of client (end() == none) differs from given one by no more than window. */
+    bool isWithinWindow(const clientsIterator&, const int&, const long long&);
+    /** Find first Ready client in bucket with rating within window (end() == none). */
+    clientsIterator findInBucket(const int&, const int&, const long long&);
+    /** Find opponent for Ready client, who is not paired yet in its rating bucket. */
+    clientsIterator findRatedOpponent(clientsIterator&, const long long&);
+    /** Pair Ready clients by rating. Returns Ready client without opponent. */
+    clientsIterator moveRatedClientsToPlay();
+
+    /** Compose response to connection with session token. */
+    FrameBuilder composeMsgRespConn(const std::uint64_t&);
     /** Compose message, which is send to client, who just entered a game. */
-    std::string composeMsgInGame(const std::string&, const std::string&);
+    FrameBuilder composeMsgInGame(const std::string&, const std::string&);
     /** Compose message, which is send to client, who have been reconnected to game. */
-    std::string composeMsgInGameRecn(Client&);
-    /** Compose message, which is send to client, who have been reconnected to lobby. */
-    std::string composeMsgInLobbyRecn();
+    FrameBuilder composeMsgInGameRecn(Client&);
 
 public:
 
@@ -62,29 +145,52 @@ public:
     /** Process received message for current client. */
     int process(Client&, clientData&);
     /** Create new client connection. */
-    void createClient(const std::string&, const int&);
+    clientsIterator createClient(const std::uint32_t&, const int&);
+    /** Insert client handed over from other shard (with its nick). */
+    clientsIterator adoptClient(const Client&, const std::string&, const long long&);
+    /** Remove client handed over to other shard, without closing its connection. */
+    void detachClient(clientsIterator&);
     /** Erase client from vector. */
     clientsIterator eraseClient(clientsIterator& client);
     /** Erase longest disconnected client from vector. */
     void eraseLongestDisconnectedClient();
 
-    /** Send message to client. */
-    int sendToClient(Client&, const std::string&);
-    /** Send message to client's opponent, when in game. */
-    void sendToOpponentOf(Client&, const std::string&);
-
+    /** Send whole frame to client. */
+    int sendToClient(Client&, const std::string_view&);
+    /** Send queued output of client. */
+    int flushClient(Client&);
+    /** Send queued output of every client, who got some since last call. */
+    void flushDirtyClients();
+    /** Send whole frame to client's opponent, when in game. */
+    void sendToOpponentOf(Client&, const std::string_view&);
+    /** Send client, whose opponent does not exist anymore, back to Lobby. */
+    void leaveOrphanedRoom(Client&);
+
+    /** Find connected client in private vector by socket. */
+    clientsIterator findClientBySocket(const int&);
+    /** Find client (also disconnected one) in private vector by key of heartbeat timer. */
+    clientsIterator findClientByTimerKey(const int&);
+    /** Find opponent of client, who is in game. */
+    clientsIterator findOpponentOf(const Client&);
     /** Find connected client in private vector by nick. */
     clientsIterator findClientByNick(const std::string&);
+    /** Find client (also disconnected one) in private vector by session token. */
+    clientsIterator findClientByToken(const std::uint64_t&);
 //    /** Find connected client in private vector by ip address. */
 //    clientsIterator findClientByIp(const std::string&);
     /** Find connected client in private vector by both nick and ip address. */
-    clientsIterator findClientByNickAndIp(const std::string&, const std::string&);
+    clientsIterator findClientByNickAndIp(const std::string&, const std::uint32_t&);
 
     /** Finds out, if there are some disconnected clients in vector. */
     bool isDisconnectedClient();
 
-    /** Checks Waiting clients and tells Lobby to send them to game. */
-    void moveReadyClientsToPlay();
+    /** Tell Server, that some client was flagged to disconnect or to erase. */
+    void markFlagged();
+    /** Returns true, if some client was flagged since last call, and resets it. */
+    bool takeFlagged();
+
+    /** Pairs Ready clients from ready queue and tells Lobby to send them to game. Returns Ready client without opponent. */
+    clientsIterator moveReadyClientsToPlay();
 
     // getters
     [[nodiscard]] int getCountClients() const;
@@ -94,10 +200,15 @@ public:
     [[nodiscard]] const int& getBytesSend() const;
     [[nodiscard]] const int& getRoomsTotal() const;
 
-    /** Access to private list of clients. */
-    std::vector<Client>& getVectorOfClients();
+    /** Access to private slots of clients. */
+    ClientSlots& getClients();
 
     // setters
+    void setReactor(Reactor*);
+    void setShards(Shards*, const int&);
+    void setOutLimit(const int&);
+    void setRated(const bool&);
+    void setMaxRooms(const int&);
     void setDisconnected(clientsIterator&);
     void setBadSocket(clientsIterator&, const int&);
 
@@ -0,0 +1,153 @@
+#include "ClientSlots.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+ClientSlots::ClientSlots() {
+    this->clients = std::vector<Client>();
+    this->generations = std::vector<unsigned>();
+    this->table = ClientTable();
+    this->freeSlots = std::vector<int>();
+    this->count = 0;
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+ClientSlots::iterator ClientSlots::begin() {
+    return iterator(this, 0);
+}
+
+ClientSlots::iterator ClientSlots::end() {
+    return iterator(this, (int) this->clients.size());
+}
+
+ClientSlots::const_iterator ClientSlots::begin() const {
+    return const_iterator(this, 0);
+}
+
+ClientSlots::const_iterator ClientSlots::end() const {
+    return const_iterator(this, (int) this->clients.size());
+}
+
+
+ClientSlots::iterator ClientSlots::insert(const Client& client) {
+    int index;
+
+    if (this->freeSlots.empty()) {
+        index = (int) this->clients.size();
+
+        this->clients.push_back(client);
+        this->generations.push_back(0);
+        this->table.grow();
+    }
+    else {
+        index = this->freeSlots.back();
+        this->freeSlots.pop_back();
+
+        this->clients[index] = client;
+    }
+
+    this->clients[index].setTable(&this->table, index);
+    this->count += 1;
+
+    return iterator(this, index);
+}
+
+
+ClientSlots::iterator ClientSlots::emplace(const std::uint32_t& ip, const int& sock) {
+    return this->insert(Client(ip, sock));
+}
+
+
+/******************************************************************************
+ *
+ * 	Free slot keeps empty client, so buffers of erased one are released,
+ * 	and next generation, so handles of erased client are not valid anymore.
+ *
+ */
+ClientSlots::iterator ClientSlots::erase(const iterator& client) {
+    int index = client.getIndex();
+
+    this->clients[index] = Client(0, -1);
+    this->generations[index] += 1;
+    this->table.release(index);
+    this->freeSlots.push_back(index);
+
+    this->count -= 1;
+
+    return iterator(this, index + 1);
+}
+
+
+ClientSlots::iterator ClientSlots::findFlagged(const iterator& from) {
+    return iterator(this, this->table.findFlagged(from.getIndex()));
+}
+
+
+ClientSlots::iterator ClientSlots::firstReady(const int& bucket) {
+    return this->at(this->table.getReadyFront(bucket));
+}
+
+
+ClientSlots::iterator ClientSlots::nextReady(const iterator& client) {
+    return this->at(this->table.getReadyAfter(client.getIndex()));
+}
+
+
+ClientSlots::iterator ClientSlots::firstDisconnected() {
+    return this->at(this->table.getDisconnectedFront());
+}
+
+
+ClientSlots::iterator ClientSlots::at(const int& index) {
+    if (index < 0 || index >= (int) this->clients.size() || !this->table.isUsed(index)) {
+        return this->end();
+    }
+
+    return iterator(this, index);
+}
+
+
+ClientSlots::iterator ClientSlots::find(const ClientHandle& handle) {
+    if (handle.index < 0 || handle.index >= (int) this->clients.size() || this->generations[handle.index] != handle.generation) {
+        return this->end();
+    }
+
+    return this->at(handle.index);
+}
+
+
+ClientHandle ClientSlots::handleOf(const Client& client) const {
+    int index = (int) (&client - this->clients.data());
+
+    return {index, this->generations[index]};
+}
+
+
+int ClientSlots::size() const {
+    return this->count;
+}
+
+const ClientTable& ClientSlots::getTable() const {
+    return this->table;
+}
+
+void ClientSlots::setRated(const bool& value) {
+    this->table.setRated(value);
+}
+
+void ClientSlots::setReadySince(const Client& client, const long long& time) {
+    this->table.setReadySince(this->handleOf(client).index, time);
+}
@@ -0,0 +1,136 @@
+#ifndef CLIENT_SLOTS_HPP
+#define CLIENT_SLOTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "Client.hpp"
+#include "ClientHandle.hpp"
+#include "ClientTable.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Slot map of clients. Client stays in its slot for whole life, so position
+ * 	of client in indexes and handle of client in game room are valid until
+ * 	it is erased. Erasing only frees the slot for next client, nothing is
+ * 	shifted. Iterating skips free slots. Hot state of clients is kept only
+ * 	in dense table, so clients in some state are found without touching
+ * 	the others.
+ *
+ */
+class ClientSlots {
+private:
+    /** Clients by slots (free slot holds empty client). */
+    std::vector<Client> clients;
+    /** Generation of every slot, increased when client in it is erased. */
+    std::vector<unsigned> generations;
+    /** Hot state of clients by slots (also tells, which slots are used). */
+    ClientTable table;
+    /** Free slots, last freed is reused first. */
+    std::vector<int> freeSlots;
+    /** Count of clients. */
+    int count;
+
+    /** Forward iterator over clients, skipping free slots. */
+    template <typename Slots, typename Value>
+    class Iterator {
+    private:
+        Slots* slots;
+        int index;
+
+        /** Move to first used slot from current one. */
+        void skipFree() {
+            this->index = this->slots->table.findUsed(this->index);
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Client;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator(Slots* s, const int& i) {
+            this->slots = s;
+            this->index = i;
+
+            this->skipFree();
+        }
+
+        Value& operator*() const {
+            return this->slots->clients[this->index];
+        }
+
+        Value* operator->() const {
+            return &this->slots->clients[this->index];
+        }
+
+        Iterator& operator++() {
+            this->index += 1;
+            this->skipFree();
+
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return this->index == other.index;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return this->index != other.index;
+        }
+
+        /** Slot of client. */
+        [[nodiscard]] const int& getIndex() const {
+            return this->index;
+        }
+    };
+
+public:
+    using iterator = Iterator<ClientSlots, Client>;
+    using const_iterator = Iterator<const ClientSlots, const Client>;
+
+    ClientSlots();
+
+    iterator begin();
+    iterator end();
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+
+    /** Put copy of client to free slot. */
+    iterator insert(const Client&);
+    /** Create client in free slot. */
+    iterator emplace(const std::uint32_t&, const int&);
+    /** Free slot of client. Returns iterator to next client. */
+    iterator erase(const iterator&);
+
+    /** First client flagged to disconnect or to erase from given one. */
+    iterator findFlagged(const iterator&);
+    /** Client, who is Ready for longest time (in given rating bucket). */
+    iterator firstReady(const int&);
+    /** Client, who became Ready next after given one. */
+    iterator nextReady(const iterator&);
+    /** Client, who is Disconnected for longest time. */
+    iterator firstDisconnected();
+
+    /** Client in given slot, end() when slot is free. */
+    iterator at(const int&);
+    /** Client with given handle, end() when it was erased meanwhile. */
+    iterator find(const ClientHandle&);
+    /** Handle of client, which is in slot map. */
+    [[nodiscard]] ClientHandle handleOf(const Client&) const;
+
+    [[nodiscard]] int size() const;
+    [[nodiscard]] const ClientTable& getTable() const;
+
+    /** Queue Ready clients by rating buckets (before any client is inserted). */
+    void setRated(const bool&);
+    /** Keep time of becoming Ready, which client had before (in other slot or shard). */
+    void setReadySince(const Client&, const long long&);
+};
+
+
+#endif
@@ -0,0 +1,327 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "ClientTable.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+ClientTable::ClientTable() {
+    this->states = std::vector<unsigned char>();
+    this->statesLast = std::vector<unsigned char>();
+    this->pings = std::vector<int>();
+    this->flags = std::vector<unsigned char>();
+    this->ratings = std::vector<int>();
+    this->nickIds = std::vector<std::uint32_t>();
+    this->nickPool = std::deque<std::string>(1);
+    this->freeNickIds = std::vector<std::uint32_t>();
+    this->readySince = std::vector<long long>();
+    this->ready = SlotQueue();
+    this->disconnected = SlotQueue();
+    this->rated = false;
+}
+
+
+
+
+
+// ---------- PRIVATE METHODS
+
+
+
+
+
+void ClientTable::setFlag(const int& slot, const unsigned char& flag, const bool& value) {
+    if (value) {
+        this->flags[slot] |= flag;
+    }
+    else {
+        this->flags[slot] &= ~flag;
+    }
+}
+
+
+void ClientTable::enqueue(const int& slot) {
+    this->ready.push(slot, this->rated ? this->getBucket(slot) : 0);
+}
+
+
+int ClientTable::skipInaccessible(int slot) const {
+    while (slot >= 0 && this->states[slot] != Ready) {
+        slot = this->ready.after(slot);
+    }
+
+    return slot;
+}
+
+
+void ClientTable::freeNick(const int& slot) {
+    std::uint32_t id = this->nickIds[slot];
+
+    if (id != NO_NICK) {
+        this->nickPool[id].clear();
+        this->freeNickIds.push_back(id);
+        this->nickIds[slot] = NO_NICK;
+    }
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void ClientTable::grow() {
+    this->states.push_back(FREE);
+    this->statesLast.push_back(New);
+    this->pings.push_back(0);
+    this->flags.push_back(0);
+    this->ratings.push_back(0);
+    this->nickIds.push_back(NO_NICK);
+    this->readySince.push_back(0);
+}
+
+
+void ClientTable::store(const int& slot, const Client& client) {
+    // rating first, it tells queue of Ready client
+    this->ratings[slot] = client.getRating();
+    this->statesLast[slot] = client.getStateLast();
+    this->setState(slot, client.getState());
+
+    // Pinged client, who was Ready, waits in queue too
+    if ((client.getState() == Pinged || client.getState() == Lost) && client.getStateLast() == Ready) {
+        this->enqueue(slot);
+    }
+
+    this->pings[slot] = client.getInaccessCount();
+    this->flags[slot] = 0;
+
+    this->setFlag(slot, FLAG_DISCONNECT, client.getFlagToDisconnect());
+    this->setFlag(slot, FLAG_ERASE, client.getFlagToErase());
+}
+
+
+void ClientTable::release(const int& slot) {
+    if (this->ready.contains(slot)) {
+        this->ready.remove(slot);
+    }
+    if (this->states[slot] == Disconnected) {
+        this->disconnected.remove(slot);
+    }
+
+    this->states[slot] = FREE;
+    this->statesLast[slot] = New;
+    this->pings[slot] = 0;
+    this->flags[slot] = 0;
+    this->freeNick(slot);
+}
+
+
+int ClientTable::findUsed(const int& from) const {
+    int last = (int) this->states.size();
+    int slot = from;
+
+    while (slot < last && this->states[slot] == FREE) {
+        slot += 1;
+    }
+
+    return slot;
+}
+
+
+/******************************************************************************
+ *
+ * 	Flagged clients are rare, so flags are tested by eight slots at once
+ * 	and only word with some flag is looked into.
+ *
+ */
+int ClientTable::findFlagged(const int& from) const {
+    int last = (int) this->flags.size();
+    int slot = from;
+
+    for (; slot + 8 <= last; slot += 8) {
+        uint64_t word;
+
+        std::memcpy(&word, this->flags.data() + slot, sizeof(word));
+
+        if (word != 0) {
+            break;
+        }
+    }
+
+    while (slot < last && this->flags[slot] == 0) {
+        slot += 1;
+    }
+
+    return slot;
+}
+
+
+long long ClientTable::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// ----- GETTERS
+
+
+bool ClientTable::isUsed(const int& slot) const {
+    return this->states[slot] != FREE;
+}
+
+State ClientTable::getState(const int& slot) const {
+    return (State) this->states[slot];
+}
+
+State ClientTable::getStateLast(const int& slot) const {
+    return (State) this->statesLast[slot];
+}
+
+bool ClientTable::getFlagToDisconnect(const int& slot) const {
+    return this->flags[slot] & FLAG_DISCONNECT;
+}
+
+bool ClientTable::getFlagToErase(const int& slot) const {
+    return this->flags[slot] & FLAG_ERASE;
+}
+
+const int& ClientTable::getInaccessCount(const int& slot) const {
+    return this->pings[slot];
+}
+
+const int& ClientTable::getRating(const int& slot) const {
+    return this->ratings[slot];
+}
+
+const std::string& ClientTable::getNick(const int& slot) const {
+    return this->nickPool[this->nickIds[slot]];
+}
+
+const long long& ClientTable::getReadySince(const int& slot) const {
+    return this->readySince[slot];
+}
+
+int ClientTable::getBucket(const int& slot) const {
+    int bucket = this->ratings[slot] / BUCKET_WIDTH;
+
+    return bucket < 0 ? 0 : (bucket >= BUCKETS ? BUCKETS - 1 : bucket);
+}
+
+int ClientTable::getReadyFront(const int& bucket) const {
+    return this->skipInaccessible(this->ready.front(bucket));
+}
+
+int ClientTable::getReadyAfter(const int& slot) const {
+    return this->skipInaccessible(this->ready.after(slot));
+}
+
+const int& ClientTable::getDisconnectedFront() const {
+    return this->disconnected.front(0);
+}
+
+
+// ----- SETTERS
+
+
+/******************************************************************************
+ *
+ * 	Client waits for opponent, while it is Ready -- it leaves the queue on
+ * 	getting to game and on disconnection, and returns to its end, when it
+ * 	is Ready again. Heartbeat makes Ready client Pinged (or Lost), but it
+ * 	keeps its place and time of becoming Ready, so order of the queue and
+ * 	window of ratings do not change with every ping. Clients get Disconnected
+ * 	one after another in time, so end of their queue is always the newest.
+ *
+ */
+void ClientTable::setState(const int& slot, const State& state) {
+    bool wasQueued = this->ready.contains(slot);
+    bool wasDisconnected = this->states[slot] == Disconnected;
+    bool waits = state == Ready || (wasQueued && (state == Pinged || state == Lost));
+
+    this->states[slot] = state;
+
+    if (wasQueued && !waits) {
+        this->ready.remove(slot);
+    }
+    else if (!wasQueued && waits) {
+        this->readySince[slot] = now();
+        this->enqueue(slot);
+    }
+
+    if (wasDisconnected && state != Disconnected) {
+        this->disconnected.remove(slot);
+    }
+    else if (!wasDisconnected && state == Disconnected) {
+        this->disconnected.push(slot, 0);
+    }
+}
+
+void ClientTable::setStateLast(const int& slot, const State& state) {
+    this->statesLast[slot] = state;
+}
+
+void ClientTable::setInaccessCount(const int& slot, const int& count) {
+    this->pings[slot] = count;
+}
+
+void ClientTable::setFlagToDisconnect(const int& slot, const bool& value) {
+    this->setFlag(slot, FLAG_DISCONNECT, value);
+}
+
+void ClientTable::setFlagToErase(const int& slot, const bool& value) {
+    this->setFlag(slot, FLAG_ERASE, value);
+}
+
+void ClientTable::setRating(const int& slot, const int& rating) {
+    this->ratings[slot] = rating;
+
+    // waiting client moves to queue of its new bucket
+    if (this->rated && this->ready.contains(slot)) {
+        this->ready.remove(slot);
+        this->enqueue(slot);
+    }
+}
+
+void ClientTable::setReadySince(const int& slot, const long long& time) {
+    this->readySince[slot] = time;
+}
+
+/******************************************************************************
+ *
+ * 	Renamed client keeps id of its nick. Id of free nick is used again,
+ * 	before pool grows.
+ *
+ */
+void ClientTable::setNick(const int& slot, const std::string& nick) {
+    if (nick.empty()) {
+        this->freeNick(slot);
+        return;
+    }
+
+    if (this->nickIds[slot] == NO_NICK) {
+        if (this->freeNickIds.empty()) {
+            this->nickIds[slot] = (std::uint32_t) this->nickPool.size();
+            this->nickPool.emplace_back();
+        }
+        else {
+            this->nickIds[slot] = this->freeNickIds.back();
+            this->freeNickIds.pop_back();
+        }
+    }
+
+    this->nickPool[this->nickIds[slot]] = nick;
+}
+
+void ClientTable::setRated(const bool& value) {
+    this->rated = value;
+    this->ready = SlotQueue(value ? BUCKETS : 1);
+}
@@ -0,0 +1,128 @@
+#ifndef CLIENT_TABLE_HPP
+#define CLIENT_TABLE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Client.hpp"
+#include "SlotQueue.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Hot state of clients in dense arrays by slot of slot map. Client in slot
+ * 	map keeps its state, last state, inaccessibility count, flags and rating
+ * 	only here and reads and writes them by its slot, so sweeps over all
+ * 	clients read only these few bytes per client instead of whole instances
+ * 	with strings and buffers. State of free slot is FREE. Clients, who are
+ * 	Ready, are also queued in order they became Ready -- in one queue, or
+ * 	in queue of their rating bucket, when matchmaking is rated. Ready client
+ * 	keeps its place, while it is Pinged or Lost, but it is not found there.
+ * 	Disconnected clients are queued in order they were disconnected.
+ * 	Nicks of clients are kept here too, so indexes by nick refer to them
+ * 	and do not keep their own copies. Slot holds only id of its nick in
+ * 	pool, which never moves nicks, so reference to nick stays valid, even
+ * 	when table grows, until the client is renamed or released.
+ *
+ */
+class ClientTable {
+public:
+    /** Count of rating buckets of rated matchmaking. */
+    constexpr static const int BUCKETS = 64;
+    /** Range of ratings in one bucket. */
+    constexpr static const int BUCKET_WIDTH = 50;
+
+private:
+    /** State of free slot. */
+    constexpr static const unsigned char FREE = 0xff;
+    /** Flag of client, whose connection is going to be closed. */
+    constexpr static const unsigned char FLAG_DISCONNECT = 0x01;
+    /** Flag of client, whose instance is going to be erased. */
+    constexpr static const unsigned char FLAG_ERASE = 0x02;
+    /** Id of empty nick in pool (client without nick). */
+    constexpr static const std::uint32_t NO_NICK = 0;
+
+    /** State of client by slot. */
+    std::vector<unsigned char> states;
+    /** Last state of client before pinging by slot. */
+    std::vector<unsigned char> statesLast;
+    /** Counter of long inaccessibility pings by slot. */
+    std::vector<int> pings;
+    /** Flags to disconnect and to erase by slot. */
+    std::vector<unsigned char> flags;
+    /** Rating of client by slot. */
+    std::vector<int> ratings;
+    /** Id of client's nick in pool by slot (NO_NICK == none yet). */
+    std::vector<std::uint32_t> nickIds;
+    /** Nicks by id, the first one is empty. */
+    std::deque<std::string> nickPool;
+    /** Ids of nicks in pool, which are not used now. */
+    std::vector<std::uint32_t> freeNickIds;
+    /** Time of becoming Ready in milliseconds (monotonic) by slot. */
+    std::vector<long long> readySince;
+    /** Slots of Ready clients, first became Ready first. */
+    SlotQueue ready;
+    /** Slots of Disconnected clients, longest disconnected first. */
+    SlotQueue disconnected;
+    /** Ready clients are queued by rating buckets. */
+    bool rated;
+
+    /** Set or clear flag of client. */
+    void setFlag(const int&, const unsigned char&, const bool&);
+    /** Put Ready client to end of its queue (time of becoming Ready stays). */
+    void enqueue(const int&);
+    /** Given slot in ready queue or first Ready one after it, -1 when none. */
+    [[nodiscard]] int skipInaccessible(int) const;
+    /** Return nick of slot to pool, slot is without nick then. */
+    void freeNick(const int&);
+
+public:
+    ClientTable();
+
+    /** Make place for one more slot (free). */
+    void grow();
+    /** Take hot state of client, which is not in slot map yet, to its slot. */
+    void store(const int&, const Client&);
+    /** Mark slot as free. */
+    void release(const int&);
+
+    /** First used slot from given one, or count of slots. */
+    [[nodiscard]] int findUsed(const int&) const;
+    /** First slot of flagged client from given one, or count of slots. */
+    [[nodiscard]] int findFlagged(const int&) const;
+
+    /** Monotonic time in milliseconds, as in times of becoming Ready. */
+    static long long now();
+
+    // getters
+    [[nodiscard]] bool isUsed(const int&) const;
+    [[nodiscard]] State getState(const int&) const;
+    [[nodiscard]] State getStateLast(const int&) const;
+    [[nodiscard]] bool getFlagToDisconnect(const int&) const;
+    [[nodiscard]] bool getFlagToErase(const int&) const;
+    [[nodiscard]] const int& getInaccessCount(const int&) const;
+    [[nodiscard]] const int& getRating(const int&) const;
+    [[nodiscard]] const std::string& getNick(const int&) const;
+    [[nodiscard]] const long long& getReadySince(const int&) const;
+    [[nodiscard]] int getBucket(const int&) const;
+    [[nodiscard]] int getReadyFront(const int&) const;
+    [[nodiscard]] int getReadyAfter(const int&) const;
+    [[nodiscard]] const int& getDisconnectedFront() const;
+
+    // setters
+    void setState(const int&, const State&);
+    void setStateLast(const int&, const State&);
+    void setInaccessCount(const int&, const int&);
+    void setFlagToDisconnect(const int&, const bool&);
+    void setFlagToErase(const int&, const bool&);
+    void setRating(const int&, const int&);
+    void setReadySince(const int&, const long long&);
+    void setNick(const int&, const std::string&);
+    /** Choose matchmaking by rating (before any client is inserted). */
+    void setRated(const bool&);
+};
+
+
+#endif
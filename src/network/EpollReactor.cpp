@@ -0,0 +1,116 @@
+// close()
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "../system/Logger.hpp"
+#include "EpollReactor.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+EpollReactor::EpollReactor() {
+    this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (this->epollFd < 0) {
+        throw std::runtime_error(std::string("Unable to create epoll instance."));
+    }
+
+    this->ready = std::vector<struct epoll_event>(SIZE_EVENTS);
+}
+
+
+EpollReactor::~EpollReactor() {
+    close(this->epollFd);
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+bool EpollReactor::add(const int& fd, Watch watch) {
+    struct epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLPRI | EPOLLRDHUP | EPOLLET;
+
+    // edge-triggered writability is reported only when full socket gets free space again,
+    // so it may be watched all the time
+    if (watch == W_Connection) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.fd = fd;
+
+    if (epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        logger->error("Socket [%d] could not be added to epoll [%s].", fd, std::strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+
+void EpollReactor::remove(const int& fd) {
+    // descriptor is removed also by close(), so failure here is not important
+    epoll_ctl(this->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+
+/******************************************************************************
+ *
+ * 	Wait for ready sockets and translate them for Server.
+ * 	Hangup is reported as readable, so Server finds out about it during read.
+ *
+ */
+int EpollReactor::wait(std::vector<ReactorEvent>& events, const int& timeoutMs) {
+    int activity = 0;
+    int flags = 0;
+
+    events.clear();
+
+    activity = epoll_wait(this->epollFd, this->ready.data(), this->ready.size(), timeoutMs);
+
+    if (activity < 0) {
+        // interrupted by signal is not an error
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < activity; ++i) {
+        flags = 0;
+
+        if (this->ready[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) {
+            flags |= R_Read;
+        }
+        if (this->ready[i].events & EPOLLOUT) {
+            flags |= R_Write;
+        }
+        if (this->ready[i].events & (EPOLLPRI | EPOLLERR)) {
+            flags |= R_Except;
+        }
+
+        events.push_back({this->ready[i].data.fd, flags, nullptr, 0});
+    }
+
+    // buffer was too small, so next time take more events at once
+    if (activity == (int) this->ready.size()) {
+        this->ready.resize(this->ready.size() * 2);
+    }
+
+    return activity;
+}
+
+
+const char* EpollReactor::getName() const {
+    return BACKEND_EPOLL;
+}
@@ -0,0 +1,37 @@
+#ifndef EPOLL_REACTOR_HPP
+#define EPOLL_REACTOR_HPP
+
+#include <sys/epoll.h>
+
+#include "Reactor.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Edge-triggered epoll loop. Watched sockets have to be non-blocking
+ * 	and have to be read until there is nothing left in them.
+ *
+ */
+class EpollReactor : public Reactor {
+private:
+    /** Initial count of events returned by one epoll_wait(). */
+    constexpr static const int SIZE_EVENTS = 64;
+
+    /** Epoll instance. */
+    int epollFd;
+    /** Buffer for events from epoll_wait(). Grows, when it is filled whole. */
+    std::vector<struct epoll_event> ready;
+
+public:
+    EpollReactor();
+    ~EpollReactor() override;
+
+    bool add(const int&, Watch) override;
+    void remove(const int&) override;
+    int wait(std::vector<ReactorEvent>&, const int&) override;
+
+    [[nodiscard]] const char* getName() const override;
+};
+
+
+#endif
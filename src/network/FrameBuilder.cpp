@@ -0,0 +1,62 @@
+#include <cstring>
+
+#include "FrameBuilder.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+FrameBuilder::FrameBuilder() {
+    this->length = 0;
+    this->overflown = false;
+
+    this->add(Protocol::OP_SOH);
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+FrameBuilder& FrameBuilder::add(const std::string_view& part) {
+    // values are validated by parser, so only bug can get here
+    if (this->overflown || this->length + (int) part.length() > CAPACITY) {
+        this->overflown = true;
+        return *this;
+    }
+
+    std::memcpy(&this->data[this->length], part.data(), part.length());
+    this->length += part.length();
+
+    return *this;
+}
+
+
+FrameBuilder& FrameBuilder::next(const std::string_view& part) {
+    return this->add(Protocol::OP_SEP).add(part);
+}
+
+
+FrameBuilder& FrameBuilder::close() {
+    return this->add(Protocol::OP_EOT);
+}
+
+
+// ----- GETTERS
+
+
+std::string_view FrameBuilder::view() const {
+    return std::string_view(this->data.data(), this->overflown ? 0 : this->length);
+}
+
+const bool& FrameBuilder::isOverflown() const {
+    return this->overflown;
+}
@@ -0,0 +1,52 @@
+#ifndef FRAME_BUILDER_HPP
+#define FRAME_BUILDER_HPP
+
+#include <array>
+#include <string_view>
+
+#include "protocol.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Builds one reply frame with variable content (nicks, moves, playfield)
+ * 	in fixed array on stack, so composing reply allocates nothing.
+ * 	Frame is opened on construction and closed by FrameBuilder::close().
+ * 	Frame is copied to client's output afterwards, instead of being built
+ * 	there -- binary client gets it transcoded from the whole text frame,
+ * 	and chat goes unchanged to the opponent. The copy is at most
+ * 	LONGEST_REPLY bytes to memory, which output already has.
+ * 	Part, which does not fit, is not appended and frame is overflown,
+ * 	its view is empty then.
+ *
+ */
+class FrameBuilder {
+private:
+    /** Longest frame. */
+    constexpr static const int CAPACITY = Protocol::LONGEST_REPLY;
+
+    /** Bytes of frame. */
+    std::array<char, CAPACITY> data;
+    /** Count of written bytes. */
+    int length;
+    /** Some part did not fit. */
+    bool overflown;
+
+public:
+    FrameBuilder();
+
+    /** Append part of message. */
+    FrameBuilder& add(const std::string_view&);
+    /** Append separator and part of message. */
+    FrameBuilder& next(const std::string_view&);
+    /** Close frame. */
+    FrameBuilder& close();
+
+    // getters
+    /** View of frame, empty when frame is overflown (valid until builder is destroyed). */
+    [[nodiscard]] std::string_view view() const;
+    [[nodiscard]] const bool& isOverflown() const;
+};
+
+
+#endif
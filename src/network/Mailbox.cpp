@@ -0,0 +1,146 @@
+// eventfd()
+#include <sys/eventfd.h>
+// close(), read(), write()
+#include <unistd.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "Mailbox.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+Letter::Letter(const Client& c, const std::string& n, const long long& t, const std::string& r) : next(nullptr), client(c), nick(n), readySince(t), rest(r) {
+}
+
+
+Mailbox::Mailbox() : stub(Client(0, -1), "", 0, "") {
+    this->head.store(&this->stub);
+    this->tail = &this->stub;
+
+    this->notifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (this->notifyFd < 0) {
+        throw std::runtime_error(std::string("Unable to create eventfd for mailbox."));
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Letters, which nobody took, are thrown away with their sockets.
+ *
+ */
+Mailbox::~Mailbox() {
+    Letter* letter = nullptr;
+
+    while ((letter = this->take()) != nullptr) {
+        close(letter->client.getSocket());
+        delete letter;
+    }
+
+    close(this->notifyFd);
+}
+
+
+
+
+
+// ---------- PRIVATE METHODS
+
+
+
+
+
+void Mailbox::push(Letter* letter) {
+    letter->next.store(nullptr, std::memory_order_relaxed);
+
+    // publish letter as the newest one and link previous newest one to it
+    Letter* prev = this->head.exchange(letter, std::memory_order_acq_rel);
+    prev->next.store(letter, std::memory_order_release);
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void Mailbox::post(Letter* letter) {
+    this->push(letter);
+    this->wake();
+}
+
+
+/******************************************************************************
+ *
+ * 	Returns nullptr also when some producer is just in the middle of posting,
+ * 	it wakes the owner after it finishes, so the letter is taken next time.
+ *
+ */
+Letter* Mailbox::take() {
+    Letter* t = this->tail;
+    Letter* next = t->next.load(std::memory_order_acquire);
+
+    // skip the stub
+    if (t == &this->stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+
+        this->tail = next;
+        t = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+        this->tail = next;
+        return t;
+    }
+
+    // producer is posting right now
+    if (t != this->head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    // last letter can't be taken, until something is after it, so put the stub there
+    this->push(&this->stub);
+
+    next = t->next.load(std::memory_order_acquire);
+
+    if (next != nullptr) {
+        this->tail = next;
+        return t;
+    }
+
+    return nullptr;
+}
+
+
+void Mailbox::drain() {
+    uint64_t count = 0;
+
+    // non-blocking, fails when counter is already zero
+    (void) !read(this->notifyFd, &count, sizeof(count));
+}
+
+
+void Mailbox::wake() {
+    uint64_t one = 1;
+
+    (void) !write(this->notifyFd, &one, sizeof(one));
+}
+
+
+const int& Mailbox::getFd() const {
+    return this->notifyFd;
+}
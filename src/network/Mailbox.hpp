@@ -0,0 +1,71 @@
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include <atomic>
+#include <string>
+
+#include "Client.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Client handed over from one shard to another one, together with its socket
+ * 	and with requests, which were received, but not served yet.
+ *
+ */
+struct Letter {
+    std::atomic<Letter*> next;
+    /** Client, who is moving (socket included). */
+    Client client;
+    /** Nick of client (copy of client is out of slot map, which keeps nicks). */
+    std::string nick;
+    /** Time of becoming Ready (kept by slot map too), so Ready client keeps its widened window. */
+    long long readySince;
+    /** Requests for the receiving shard to serve, eg. "{c:nick}". */
+    std::string rest;
+
+    Letter(const Client&, const std::string&, const long long&, const std::string&);
+};
+
+
+/******************************************************************************
+ *
+ * 	Lock-free queue of letters for one shard. Any shard may post (multiple producers),
+ * 	only the owning shard takes (single consumer). Posting wakes the owner through
+ * 	eventfd, which is watched by the owner's reactor.
+ *
+ */
+class Mailbox {
+private:
+    /** Empty letter, queue is never empty because of it. */
+    Letter stub;
+    /** Last posted letter (producers). */
+    std::atomic<Letter*> head;
+    /** Next letter to take (consumer). */
+    Letter* tail;
+
+    /** Eventfd for waking the owner. */
+    int notifyFd;
+
+    /** Insert letter to queue without waking the owner. */
+    void push(Letter*);
+
+public:
+    Mailbox();
+    ~Mailbox();
+
+    /** Post letter and wake the owner. */
+    void post(Letter*);
+    /** Take next letter, nullptr if there is none. */
+    Letter* take();
+    /** Clear wake up counter, called by owner before taking letters. */
+    void drain();
+    /** Wake the owner without letter. */
+    void wake();
+
+    /** Descriptor for owner's reactor. */
+    [[nodiscard]] const int& getFd() const;
+};
+
+
+#endif
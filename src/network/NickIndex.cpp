@@ -0,0 +1,140 @@
+#include <functional>
+
+#include "NickIndex.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+NickIndex::NickIndex(const ClientTable* t) {
+    this->slots = std::vector<Slot>(MIN_CAPACITY, Slot{0, -1});
+    this->mask = MIN_CAPACITY - 1;
+    this->count = 0;
+    this->table = t;
+}
+
+
+
+
+
+// ---------- PRIVATE METHODS
+
+
+
+
+
+unsigned NickIndex::hashOf(const std::string& nick) {
+    return std::hash<std::string>()(nick);
+}
+
+
+int NickIndex::probe(const std::string& nick, const unsigned& hash) const {
+    unsigned i = hash & this->mask;
+
+    // there is always some empty slot, because table is at most half full
+    while (this->slots[i].position >= 0 && (this->slots[i].hash != hash || this->table->getNick(this->slots[i].position) != nick)) {
+        i = (i + 1) & this->mask;
+    }
+
+    return i;
+}
+
+
+int NickIndex::probeEmpty(const unsigned& hash) const {
+    unsigned i = hash & this->mask;
+
+    while (this->slots[i].position >= 0) {
+        i = (i + 1) & this->mask;
+    }
+
+    return i;
+}
+
+
+/******************************************************************************
+ *
+ * 	Nicks in index are unique, so they are not compared again.
+ *
+ */
+void NickIndex::grow() {
+    std::vector<Slot> old(this->slots.size() * 2, Slot{0, -1});
+
+    old.swap(this->slots);
+    this->mask = this->slots.size() - 1;
+
+    for (const auto& slot : old) {
+        if (slot.position >= 0) {
+            this->slots[this->probeEmpty(slot.hash)] = slot;
+        }
+    }
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void NickIndex::insert(const std::string& nick, const int& position) {
+    unsigned hash = hashOf(nick);
+    int i = this->probe(nick, hash);
+
+    if (this->slots[i].position < 0) {
+        if ((this->count + 1) * 2 > (int) this->slots.size()) {
+            this->grow();
+            i = this->probe(nick, hash);
+        }
+
+        this->slots[i].hash = hash;
+        this->count += 1;
+    }
+
+    this->slots[i].position = position;
+}
+
+
+/******************************************************************************
+ *
+ * 	Following slots of the same run are shifted back to the freed one,
+ * 	unless their home slot is between the freed slot and them.
+ *
+ */
+void NickIndex::erase(const std::string& nick) {
+    unsigned i = this->probe(nick, hashOf(nick));
+    unsigned j = i;
+
+    if (this->slots[i].position < 0) {
+        return;
+    }
+
+    while (true) {
+        j = (j + 1) & this->mask;
+
+        if (this->slots[j].position < 0) {
+            break;
+        }
+
+        unsigned home = this->slots[j].hash & this->mask;
+
+        // distance from home to slot j is at least distance from i to j
+        if (((j - home) & this->mask) >= ((j - i) & this->mask)) {
+            this->slots[i] = this->slots[j];
+            i = j;
+        }
+    }
+
+    this->slots[i].position = -1;
+    this->count -= 1;
+}
+
+
+int NickIndex::find(const std::string& nick) const {
+    return this->slots[this->probe(nick, hashOf(nick))].position;
+}
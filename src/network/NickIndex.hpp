@@ -0,0 +1,60 @@
+#ifndef NICK_INDEX_HPP
+#define NICK_INDEX_HPP
+
+#include <string>
+#include <vector>
+
+#include "ClientTable.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Position of client in vector of clients by nick. Open addressing with
+ * 	linear probing, so one lookup is mostly one or two neighbouring slots.
+ * 	Erasing shifts following slots back instead of leaving tombstones,
+ * 	so the table stays short to probe, even when clients come and go.
+ * 	Nicks themselves are in table of clients, index keeps only positions.
+ *
+ */
+class NickIndex {
+private:
+    /** Count of slots of new index (power of 2). */
+    constexpr static const int MIN_CAPACITY = 64;
+
+    /** One slot of table (position -1 == empty). */
+    struct Slot {
+        unsigned hash;
+        int position;
+    };
+
+    /** Table of slots, at most half full. */
+    std::vector<Slot> slots;
+    /** Mask for indexing slots with hash. */
+    unsigned mask;
+    /** Count of used slots. */
+    int count;
+    /** Table with nicks of clients by position. */
+    const ClientTable* table;
+
+    /** Hash of nick. */
+    static unsigned hashOf(const std::string&);
+    /** Slot with given nick, or empty slot, where it belongs. */
+    [[nodiscard]] int probe(const std::string&, const unsigned&) const;
+    /** First empty slot from home of given hash. */
+    [[nodiscard]] int probeEmpty(const unsigned&) const;
+    /** Double count of slots and insert everything again. */
+    void grow();
+
+public:
+    explicit NickIndex(const ClientTable* = nullptr);
+
+    /** Set position of client with given nick (nick is already in table at that position). */
+    void insert(const std::string&, const int&);
+    /** Remove nick from index. */
+    void erase(const std::string&);
+    /** Position of client with given nick, -1 when there is none. */
+    [[nodiscard]] int find(const std::string&) const;
+};
+
+
+#endif
@@ -0,0 +1,104 @@
+// send()
+#include <sys/socket.h>
+
+#include <cerrno>
+
+#include "OutBuffer.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+OutBuffer::OutBuffer() {
+    this->data = std::string();
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void OutBuffer::push(const std::string_view& frame) {
+    this->data.append(frame);
+}
+
+
+/******************************************************************************
+ *
+ * 	Send waiting bytes with MSG_NOSIGNAL, so closed connection does not
+ * 	raise SIGPIPE. Socket is non-blocking, so when it is full, the rest
+ * 	simply stays queued.
+ *
+ */
+int OutBuffer::flush(const int& sock) {
+    int sent_total = 0;
+    int sent = 0;
+
+    while (sent_total < (int) this->data.length()) {
+        sent = send(sock, &this->data[sent_total], this->data.length() - sent_total, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // socket is full, rest waits for writable socket
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            return -1;
+        }
+
+        sent_total += sent;
+    }
+
+    // drop sent bytes, memory stays for next frames
+    this->data.erase(0, sent_total);
+
+    return sent_total;
+}
+
+
+/******************************************************************************
+ *
+ * 	Waiting bytes are moved as one message, buffer starts again empty.
+ *
+ */
+int OutBuffer::takeAll(std::deque<std::string>& queue) {
+    int taken = this->data.length();
+
+    if (taken == 0) {
+        return 0;
+    }
+
+    queue.push_back(std::move(this->data));
+    this->data = std::string();
+
+    return taken;
+}
+
+
+void OutBuffer::clear() {
+    this->data.clear();
+}
+
+
+// ----- GETTERS
+
+
+int OutBuffer::getLength() const {
+    return this->data.length();
+}
+
+bool OutBuffer::isEmpty() const {
+    return this->data.empty();
+}
@@ -0,0 +1,40 @@
+#ifndef OUT_BUFFER_HPP
+#define OUT_BUFFER_HPP
+
+#include <deque>
+#include <string>
+#include <string_view>
+
+
+/******************************************************************************
+ *
+ * 	Outbound bytes of one client's connection. Frames are appended here
+ * 	and sent without blocking, all at once by one send. What the socket
+ * 	can't take now waits here, until the socket is writable again.
+ * 	Memory of buffer is kept, so queuing frame does not allocate.
+ *
+ */
+class OutBuffer {
+private:
+    /** Frames waiting for sending, one after another. */
+    std::string data;
+
+public:
+    OutBuffer();
+
+    /** Queue frame. */
+    void push(const std::string_view&);
+    /** Send as much as socket takes without blocking. Returns count of sent bytes, -1 on error. */
+    int flush(const int&);
+    /** Move all waiting bytes to given queue (eg. for asynchronous sending). Returns count of moved bytes. */
+    int takeAll(std::deque<std::string>&);
+    /** Throw away everything. */
+    void clear();
+
+    // getters
+    [[nodiscard]] int getLength() const;
+    [[nodiscard]] bool isEmpty() const;
+};
+
+
+#endif
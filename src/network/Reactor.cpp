@@ -0,0 +1,79 @@
+// close()
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "../system/Logger.hpp"
+#include "EpollReactor.hpp"
+#include "Reactor.hpp"
+#include "SelectReactor.hpp"
+#include "UringReactor.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Creates event loop backend according to its name.
+ * 	When kernel does not support io_uring, falls back to epoll.
+ * 	Throws an exception, if name is unknown or backend can't be initialized.
+ *
+ */
+std::unique_ptr<Reactor> Reactor::create(const char* name) {
+    std::unique_ptr<Reactor> reactor = nullptr;
+
+    if (strcmp(name, BACKEND_URING) == 0) {
+        try {
+            reactor = std::make_unique<UringReactor>();
+        }
+        catch (const std::exception& ex) {
+            logger->warning("%s Falling back to [%s].", ex.what(), BACKEND_EPOLL);
+            reactor = std::make_unique<EpollReactor>();
+        }
+    }
+    else if (strcmp(name, BACKEND_EPOLL) == 0) {
+        reactor = std::make_unique<EpollReactor>();
+    }
+    else if (strcmp(name, BACKEND_SELECT) == 0) {
+        reactor = std::make_unique<SelectReactor>();
+    }
+    else {
+        throw std::runtime_error(std::string("Unknown event loop backend."));
+    }
+
+    return reactor;
+}
+
+
+bool Reactor::isBackend(const char* name) {
+    return strcmp(name, BACKEND_URING) == 0 || strcmp(name, BACKEND_EPOLL) == 0 || strcmp(name, BACKEND_SELECT) == 0;
+}
+
+
+void Reactor::closeSocket(const int& fd) {
+    this->remove(fd);
+    close(fd);
+}
+
+
+int Reactor::handOver(const int& fd) {
+    this->remove(fd);
+
+    return fd;
+}
+
+
+/******************************************************************************
+ *
+ * 	Send directly from the queue, whatever socket does not take now, is sent
+ * 	after the reactor reports socket as writable.
+ *
+ */
+int Reactor::flush(const int& fd, OutBuffer& out) {
+    return out.flush(fd);
+}
+
+
+int Reactor::flushLast(const int& fd, OutBuffer& out) {
+    return this->flush(fd, out);
+}
@@ -0,0 +1,82 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <memory>
+#include <vector>
+
+#include "OutBuffer.hpp"
+
+
+/** What is watched file descriptor used for. */
+enum Watch {
+    W_Listener,
+    W_Connection,
+    /** Eventfd or timerfd, which only wakes the loop. */
+    W_Notify
+};
+
+/** Readiness flags of one file descriptor returned from Reactor::wait(). */
+enum Ready {
+    /** Socket is readable, Server has to read it. */
+    R_Read   = 1,
+    /** Socket has an error. */
+    R_Except = 2,
+    /** Reactor already received data from socket (zero length == end of connection). */
+    R_Data   = 4,
+    /** Reactor already accepted new connection, fd is the new socket. */
+    R_Accept = 8,
+    /** Socket may take more data, queued output should be flushed. */
+    R_Write  = 16
+};
+
+/** One file descriptor with changes after Reactor::wait(). */
+struct ReactorEvent {
+    int fd;
+    int flags;
+    /** Received data with R_Data flag, valid until next Reactor::wait(). */
+    const char* data;
+    int len;
+};
+
+
+/******************************************************************************
+ *
+ * 	Event loop backend. Server only tells, which sockets to watch, and gets back
+ * 	only those sockets, which are ready, so Server does not have to scan all of them.
+ *
+ */
+class Reactor {
+public:
+    /** Names of backends, which may be chosen on startup. */
+    constexpr static const char* BACKEND_SELECT = "select";
+    constexpr static const char* BACKEND_EPOLL  = "epoll";
+    constexpr static const char* BACKEND_URING  = "uring";
+
+    virtual ~Reactor() = default;
+
+    /** Start watching file descriptor. Returns false, if it can't be watched. */
+    virtual bool add(const int&, Watch) = 0;
+    /** Stop watching file descriptor. */
+    virtual void remove(const int&) = 0;
+    /** Stop watching socket and close it (backend may close it later, after its output). */
+    virtual void closeSocket(const int&);
+    /** Stop watching socket, which goes to other shard. Returns descriptor for the other shard, -1 on failure. */
+    virtual int handOver(const int&);
+    /** Wait for changes for given milliseconds. Returns count of ready descriptors, -1 on error. */
+    virtual int wait(std::vector<ReactorEvent>&, const int&) = 0;
+    /** Send queued output to socket without blocking. Returns count of sent (or taken) bytes, -1 on failure. */
+    virtual int flush(const int&, OutBuffer&);
+    /** Send last output of socket, which is going to be removed and closed. Returns as flush(). */
+    virtual int flushLast(const int&, OutBuffer&);
+
+    /** Name of the backend. */
+    [[nodiscard]] virtual const char* getName() const = 0;
+
+    /** Create backend by its name. If backend could not be created, throws an exception. */
+    static std::unique_ptr<Reactor> create(const char*);
+    /** Returns true, if given string is name of some backend. */
+    static bool isBackend(const char*);
+};
+
+
+#endif
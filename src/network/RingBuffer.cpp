@@ -0,0 +1,403 @@
+// readv()
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "binary_codec.hpp"
+#include "frame_scan.hpp"
+#include "RingBuffer.hpp"
+
+
+thread_local std::vector<std::unique_ptr<char[]>> RingBuffer::pool;
+
+
+
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+RingBuffer::RingBuffer() {
+    this->data = nullptr;
+    this->head = 0;
+    this->tail = 0;
+    this->closed = false;
+}
+
+
+/******************************************************************************
+ *
+ * 	Client is copied, when it moves to other shard, so waiting bytes go
+ * 	with it. Empty ring is copied without memory.
+ *
+ */
+RingBuffer::RingBuffer(const RingBuffer& other) {
+    this->data = nullptr;
+    this->head = other.head;
+    this->tail = other.tail;
+    this->closed = other.closed;
+
+    if (other.data != nullptr) {
+        this->allocate();
+        std::memcpy(&this->data[0], &other.data[0], CAPACITY);
+    }
+}
+
+
+RingBuffer::RingBuffer(RingBuffer&& other) noexcept {
+    this->data = std::move(other.data);
+    this->head = other.head;
+    this->tail = other.tail;
+    this->closed = other.closed;
+}
+
+
+RingBuffer::~RingBuffer() {
+    this->giveBack();
+}
+
+
+RingBuffer& RingBuffer::operator=(const RingBuffer& other) {
+    if (this != &other) {
+        if (other.data == nullptr) {
+            this->giveBack();
+        }
+        else {
+            this->allocate();
+            std::memcpy(&this->data[0], &other.data[0], CAPACITY);
+        }
+
+        this->head = other.head;
+        this->tail = other.tail;
+        this->closed = other.closed;
+    }
+
+    return *this;
+}
+
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& other) noexcept {
+    if (this != &other) {
+        this->giveBack();
+
+        this->data = std::move(other.data);
+        this->head = other.head;
+        this->tail = other.tail;
+        this->closed = other.closed;
+    }
+
+    return *this;
+}
+
+
+
+
+
+// ---------- PRIVATE METHODS
+
+
+
+
+
+/******************************************************************************
+ *
+ * 	New memory is not zeroed, ring is read only up to head.
+ *
+ */
+void RingBuffer::allocate() {
+    if (this->data != nullptr) {
+        return;
+    }
+
+    if (pool.empty()) {
+        this->data.reset(new char[CAPACITY]);
+    }
+    else {
+        this->data = std::move(pool.back());
+        pool.pop_back();
+    }
+}
+
+
+void RingBuffer::release() {
+    if (this->head == this->tail) {
+        this->giveBack();
+        this->head = 0;
+        this->tail = 0;
+    }
+}
+
+
+void RingBuffer::giveBack() {
+    if (this->data != nullptr && pool.size() < POOL_SIZE) {
+        pool.push_back(std::move(this->data));
+    }
+
+    this->data = nullptr;
+}
+
+
+char RingBuffer::at(const unsigned& position) const {
+    return this->data[position & MASK];
+}
+
+
+bool RingBuffer::isSkipped(const char& c) {
+    return c == '\n' || c == '\r' || c == '\0';
+}
+
+
+/******************************************************************************
+ *
+ * 	Received bytes may wrap around end of ring, so the wrapped part
+ * 	(which is newer) is searched first. memrchr() is vectorized by libc.
+ *
+ */
+unsigned RingBuffer::findFrameEnd() const {
+    unsigned length = this->getLength();
+    unsigned start = this->tail & MASK;
+    unsigned first = std::min(length, CAPACITY - start);
+    const void* found = nullptr;
+
+    if (length == 0) {
+        return this->tail;
+    }
+
+    found = memrchr(&this->data[0], '}', length - first);
+
+    if (found != nullptr) {
+        return this->tail + first + ((const char*) found - &this->data[0]) + 1;
+    }
+
+    found = memrchr(&this->data[start], '}', first);
+
+    if (found != nullptr) {
+        return this->tail + ((const char*) found - &this->data[start]) + 1;
+    }
+
+    return this->tail;
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+/******************************************************************************
+ *
+ * 	Socket is non-blocking, so it is read until it would block. Free space
+ * 	of ring may wrap around its end, so both parts are read by one readv().
+ *
+ */
+int RingBuffer::receive(const int& sock) {
+    int received_total = 0;
+    int received = 0;
+    unsigned start = 0;
+    unsigned space = 0;
+    struct iovec parts[2]{};
+
+    this->allocate();
+
+    while (true) {
+        // client is flooding the server
+        if (this->isFull()) {
+            return -1;
+        }
+
+        start = this->head & MASK;
+        space = CAPACITY - this->getLength();
+
+        parts[0].iov_base = &this->data[start];
+        parts[0].iov_len = std::min(space, CAPACITY - start);
+        parts[1].iov_base = &this->data[0];
+        parts[1].iov_len = space - parts[0].iov_len;
+
+        received = readv(sock, parts, parts[1].iov_len > 0 ? 2 : 1);
+
+        if (received > 0) {
+            this->head += received;
+            received_total += received;
+        }
+        // peer closed connection
+        else if (received == 0) {
+            this->closed = true;
+            break;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        else if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    return received_total;
+}
+
+
+bool RingBuffer::write(const char* src, const int& len) {
+    unsigned start = this->head & MASK;
+    unsigned first = 0;
+
+    if (len > CAPACITY - this->getLength()) {
+        return false;
+    }
+
+    this->allocate();
+
+    first = std::min((unsigned) len, CAPACITY - start);
+
+    std::memcpy(&this->data[start], src, first);
+    std::memcpy(&this->data[0], src + first, len - first);
+
+    this->head += len;
+
+    return true;
+}
+
+
+/******************************************************************************
+ *
+ * 	Every frame ends with '}', so everything up to the last one is taken.
+ * 	Newlines (eg. from telnet) and null characters (eg. from C clients)
+ * 	are not part of protocol and are skipped.
+ * 	Unfinished frame, which can't be valid anymore, is taken too, so it
+ * 	is refused by validation right away and does not wait for its end.
+ *
+ */
+void RingBuffer::takeFrames(std::string& frames) {
+    unsigned end = this->findFrameEnd();
+    unsigned start = 0;
+    unsigned count = 0;
+    unsigned first = 0;
+    std::size_t taken = 0;
+
+    frames.clear();
+
+    // skip also newlines after the last frame
+    while (end != this->head && isSkipped(this->at(end))) {
+        ++end;
+    }
+
+    // unfinished frame has to look like the beginning of one
+    if (end != this->head && (this->at(end) != '{' || this->head - end >= LONGEST_FRAME)) {
+        end = this->head;
+    }
+
+    if (end == this->tail) {
+        this->release();
+        return;
+    }
+
+    start = this->tail & MASK;
+    count = end - this->tail;
+    first = std::min(count, CAPACITY - start);
+
+    // copy both parts of ring without newlines at once
+    frames.resize(count);
+    taken = stripSkipped(&this->data[start], first, &frames[0]);
+    taken += stripSkipped(&this->data[0], count - first, &frames[taken]);
+    frames.resize(taken);
+
+    this->tail = end;
+    this->release();
+}
+
+
+/******************************************************************************
+ *
+ * 	Binary messages are walked by their headers. Message, which is longer
+ * 	than the longest valid one, is taken with everything after it, so it
+ * 	is refused by decoding right away.
+ *
+ */
+void RingBuffer::takeMessages(std::string& messages) {
+    // opcode and the longest varint
+    char header[3];
+    unsigned end = this->tail;
+    unsigned start = this->tail & MASK;
+    unsigned first = 0;
+    int available = 0;
+    int length = 0;
+    int payload = 0;
+
+    messages.clear();
+
+    while (end != this->head) {
+        available = std::min(this->head - end, (unsigned) sizeof(header));
+
+        for (int i = 0; i < available; ++i) {
+            header[i] = this->at(end + i);
+        }
+
+        length = headerLength(header, available, payload);
+
+        // header is not complete yet
+        if (length == 0) {
+            break;
+        }
+
+        if (length < 0 || payload > LONGEST_FRAME) {
+            end = this->head;
+            break;
+        }
+
+        // payload is not complete yet
+        if (this->head - end < (unsigned) (length + payload)) {
+            break;
+        }
+
+        end += length + payload;
+    }
+
+    first = std::min(end - this->tail, CAPACITY - start);
+
+    messages.resize(end - this->tail);
+
+    if (!messages.empty()) {
+        std::memcpy(&messages[0], &this->data[start], first);
+        std::memcpy(&messages[first], &this->data[0], messages.length() - first);
+    }
+
+    this->tail = end;
+    this->release();
+}
+
+
+void RingBuffer::markClosed() {
+    this->closed = true;
+}
+
+
+void RingBuffer::clear() {
+    this->giveBack();
+    this->head = 0;
+    this->tail = 0;
+    this->closed = false;
+}
+
+
+// ----- GETTERS
+
+
+int RingBuffer::getLength() const {
+    return this->head - this->tail;
+}
+
+bool RingBuffer::isFull() const {
+    return this->getLength() == CAPACITY;
+}
+
+bool RingBuffer::isClosed() const {
+    return this->closed;
+}
@@ -0,0 +1,85 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/******************************************************************************
+ *
+ * 	Receive buffer of one client's connection. Socket is read directly into
+ * 	free space of the ring and only whole {...} frames are taken out of it,
+ * 	so frame split between more TCP segments waits here for its end.
+ * 	Memory is held only while some bytes wait in the ring, so idle client
+ * 	(which is nearly every client of turn-based game) holds none. Drained
+ * 	ring gives its memory back to pool of the thread, next receive takes
+ * 	it from there, so message does not cost allocation.
+ *
+ */
+class RingBuffer {
+private:
+    /** Size of ring (power of 2). Not possible to fill during turn-based game, unless flooding. */
+    constexpr static const int CAPACITY = 1024;
+    /** Mask for indexing ring with counters. */
+    constexpr static const unsigned MASK = CAPACITY - 1;
+    /** Longest valid frame (chat), longer unfinished frame is not valid one. */
+    constexpr static const int LONGEST_FRAME = 106;
+    /** Most of drained rings kept by pool of one thread, more are freed. */
+    constexpr static const int POOL_SIZE = 64;
+
+    /** Memory of drained rings of this thread (shard), ready for next receive. */
+    static thread_local std::vector<std::unique_ptr<char[]>> pool;
+
+    /** Received bytes (taken from pool on receive, given back when drained). */
+    std::unique_ptr<char[]> data;
+    /** Count of bytes written to ring. */
+    unsigned head;
+    /** Count of bytes taken from ring. */
+    unsigned tail;
+    /** Peer closed its side of connection. */
+    bool closed;
+
+    /** Take memory of ring from pool, if there is none yet. */
+    void allocate();
+    /** Give memory of ring back to pool, if everything was taken from it. */
+    void release();
+    /** Give memory of ring back to pool, or free it, if pool is full. */
+    void giveBack();
+    /** Byte on given position of counter. */
+    [[nodiscard]] char at(const unsigned&) const;
+    /** Characters, which are not part of protocol. */
+    static bool isSkipped(const char&);
+    /** Counter just after the last received '}', or tail, when there is none. */
+    [[nodiscard]] unsigned findFrameEnd() const;
+
+public:
+    RingBuffer();
+    RingBuffer(const RingBuffer&);
+    RingBuffer(RingBuffer&&) noexcept;
+    ~RingBuffer();
+
+    RingBuffer& operator=(const RingBuffer&);
+    RingBuffer& operator=(RingBuffer&&) noexcept;
+
+    /** Read socket until there is nothing more. Returns received bytes, or -1 on error or when ring is full. */
+    int receive(const int&);
+    /** Copy already received bytes to ring. Returns false, if they do not fit. */
+    bool write(const char*, const int&);
+    /** Move whole frames (without newlines) to given string, unfinished frame stays. */
+    void takeFrames(std::string&);
+    /** Move whole binary messages to given string, unfinished message stays. */
+    void takeMessages(std::string&);
+    /** Mark connection as closed by peer. */
+    void markClosed();
+    /** Throw away everything and give memory back. */
+    void clear();
+
+    // getters
+    [[nodiscard]] int getLength() const;
+    [[nodiscard]] bool isFull() const;
+    [[nodiscard]] bool isClosed() const;
+};
+
+
+#endif
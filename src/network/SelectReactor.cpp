@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cerrno>
+
+#include "../system/Logger.hpp"
+#include "SelectReactor.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+SelectReactor::SelectReactor() {
+    FD_ZERO(&(this->sockets));
+    FD_ZERO(&(this->writers));
+    this->fds = std::vector<int>();
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+bool SelectReactor::add(const int& fd, Watch) {
+    // select can't watch descriptors over its limit
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        logger->warning("Socket [%d] is out of select() range [%d].", fd, FD_SETSIZE);
+        return false;
+    }
+
+    FD_SET(fd, &(this->sockets));
+    this->fds.push_back(fd);
+
+    return true;
+}
+
+
+void SelectReactor::remove(const int& fd) {
+    auto wanted = std::find(this->fds.begin(), this->fds.end(), fd);
+
+    if (wanted != this->fds.end()) {
+        FD_CLR(fd, &(this->sockets));
+        FD_CLR(fd, &(this->writers));
+        // order of descriptors does not matter
+        *wanted = this->fds.back();
+        this->fds.pop_back();
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Make copy of watched sockets, wait on select and collect changed ones.
+ *
+ */
+int SelectReactor::wait(std::vector<ReactorEvent>& events, const int& timeoutMs) {
+    int activity = 0;
+    int fd_max = -1;
+    int flags = 0;
+
+    // sockets for comparing changes on sockets
+    fd_set fdsRead = this->sockets;
+    fd_set fdsWrite = this->writers;
+    fd_set fdsExcept = this->sockets;
+
+    // time structure for timeout
+    struct timeval tv{};
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+    events.clear();
+
+    for (const auto& fd : this->fds) {
+        fd_max = std::max(fd_max, fd);
+    }
+
+    activity = select(fd_max + 1, &fdsRead, &fdsWrite, &fdsExcept, &tv);
+
+    if (activity < 0) {
+        // interrupted by signal is not an error
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (const auto& fd : this->fds) {
+        if (activity == 0) {
+            break;
+        }
+
+        flags = 0;
+
+        // select counts every set descriptor in every set
+        if (FD_ISSET(fd, &fdsRead)) {
+            flags |= R_Read;
+            --activity;
+        }
+        if (FD_ISSET(fd, &fdsWrite)) {
+            flags |= R_Write;
+            --activity;
+        }
+        if (FD_ISSET(fd, &fdsExcept)) {
+            flags |= R_Except;
+            --activity;
+        }
+
+        if (flags != 0) {
+            events.push_back({fd, flags, nullptr, 0});
+        }
+    }
+
+    return events.size();
+}
+
+
+/******************************************************************************
+ *
+ * 	Select is level-triggered, so socket is watched for writing only
+ * 	while it has some output, which it did not take.
+ *
+ */
+int SelectReactor::flush(const int& fd, OutBuffer& out) {
+    int sent = Reactor::flush(fd, out);
+
+    if (out.isEmpty()) {
+        FD_CLR(fd, &(this->writers));
+    }
+    else {
+        FD_SET(fd, &(this->writers));
+    }
+
+    return sent;
+}
+
+
+const char* SelectReactor::getName() const {
+    return BACKEND_SELECT;
+}
@@ -0,0 +1,35 @@
+#ifndef SELECT_REACTOR_HPP
+#define SELECT_REACTOR_HPP
+
+#include <sys/select.h>
+
+#include "Reactor.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Original select() loop. Limited to FD_SETSIZE descriptors.
+ *
+ */
+class SelectReactor : public Reactor {
+private:
+    /** Watched sockets. */
+    fd_set sockets{};
+    /** Sockets with output, which they did not take yet. */
+    fd_set writers{};
+    /** Watched sockets as list, so only them are checked after select. */
+    std::vector<int> fds;
+
+public:
+    SelectReactor();
+
+    bool add(const int&, Watch) override;
+    void remove(const int&) override;
+    int wait(std::vector<ReactorEvent>&, const int&) override;
+    int flush(const int&, OutBuffer&) override;
+
+    [[nodiscard]] const char* getName() const override;
+};
+
+
+#endif
@@ -1,7 +1,7 @@
-// inet_addr()
+// inet_pton(), inet_ntoa()
 #include <arpa/inet.h>
-// ioctl()
-#include <sys/ioctl.h>
+// TCP_NODELAY
+#include <netinet/tcp.h>
 // socket()
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -10,10 +10,10 @@
 
 #include <cerrno>
 #include <cstring>
-#include <thread>
 
 #include "../system/Logger.hpp"
 #include "../system/signal.hpp"
+#include "binary_codec.hpp"
 #include "packet_handler.hpp"
 #include "Server.hpp"
 
@@ -31,22 +31,39 @@
  *
  */
 
-Server::Server(const char* addr, const int& port, const int& clients, const int& rooms) {
+Server::Server(const char* addr, const int& port, const int& clients, const int& rooms, const char* backend,
+               const int& outLimit, const int& backlog, const bool& rated, Shards* shs, const int& id) {
     // basic initialization
-    this->maxClients = clients + 1; // +1 for client, who is told, that server is full
+    this->maxClients = clients;
     this->maxRooms   = rooms;
 
-    this->sockets       = {0};
+    this->shards  = shs;
+    this->shardId = id;
+
+    this->mngClient.setOutLimit(outLimit);
+    this->mngClient.setRated(rated);
+    this->mngClient.setMaxRooms(rooms);
+
+    this->reactor       = nullptr;
+    this->events        = std::vector<ReactorEvent>();
+    this->wheel         = nullptr;
+    this->expired       = std::vector<int>();
     this->serverAddress = {0};
     this->serverSocket  = 0;
+    this->acceptPending = false;
+    this->acceptBlocked = false;
 
-    this->clearBuffer(this->buffer);
+    this->buffer = std::string();
+    this->buffer.reserve(SIZE_BUFF);
+    this->requests = clientData();
+    this->messages = std::string();
 
     this->bytesRecv = 0;
+    this->connShed = 0;
 
     // initialize server
     try {
-        this->init(addr, port);
+        this->init(addr, port, backend, backlog);
     }
     catch (const std::exception& ex) {
         logger->error("%s [%s]. IP address [%s] port: [%d] ", ex.what(), std::strerror(errno), addr, port);
@@ -71,21 +88,30 @@ Server::Server(const char* addr, const int& port, const int& clients, const int&
  * Initializes server's address and port.
  * Binds server's socket with address, if fails, throws an exception.
  * Starts listening on given port, if fails, throws an exception.
- * Initializes file descriptors -- clears wait file descriptor
- * and sets server file descriptor.
+ * Creates event loop backend and lets it watch server socket
+ * and timer wheel, if fails, throws an exception.
  *
  */
-void Server::init(const char* ipAddress, const int& port) {
+void Server::init(const char* ipAddress, const int& port, const char* backend, const int& backlog) {
     // --- INIT SOCKET ---
 
-    // create server socket
-    this->serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    // create server socket (non-blocking, so all pending connections may be accepted at once)
+    this->serverSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
 
     // check socket creation
     if (this->serverSocket < 0) {
         throw std::runtime_error(std::string("Unable to create server socket."));
     }
 
+    // every shard has its own server socket on same port, kernel spreads connections among them
+    if (this->shards->getCount() > 1) {
+        int reuse = 1;
+
+        if (setsockopt(this->serverSocket, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) != 0) {
+            throw std::runtime_error(std::string("Unable to share server socket among shards."));
+        }
+    }
+
     // --- INIT ADDRESS ---
 
     // fill server socket
@@ -106,29 +132,53 @@ void Server::init(const char* ipAddress, const int& port) {
     // --- INIT LISTEN ---
 
     // start listening on server socket
-    if (listen(this->serverSocket, BACK_LOG) != 0) {
+    if (listen(this->serverSocket, backlog) != 0) {
         throw std::runtime_error(std::string("Unable to listen on server socket."));
     }
 
-    // --- INIT FD ---
+    // --- INIT REACTOR ---
+
+    // create event loop backend
+    this->reactor = Reactor::create(backend);
+
+    // watch server socket
+    if (!this->reactor->add(this->serverSocket, W_Listener)) {
+        throw std::runtime_error(std::string("Unable to watch server socket."));
+    }
+
+    // watch mailbox of this shard
+    if (!this->reactor->add(this->shards->getMailbox(this->shardId).getFd(), W_Notify)) {
+        throw std::runtime_error(std::string("Unable to watch mailbox of shard."));
+    }
+
+    // --- INIT TIMERS ---
 
-    // clear client sockets
-    FD_ZERO(&(this->sockets));
-    // set server socket
-    FD_SET(this->serverSocket, &(this->sockets));
+    this->wheel = std::make_unique<TimerWheel>(TICK_MSEC);
+
+    // watch ticks of timer wheel
+    if (!this->reactor->add(this->wheel->getFd(), W_Notify)) {
+        throw std::runtime_error(std::string("Unable to watch timer wheel."));
+    }
+
+    this->wheel->schedule(STATS_TIMER, PING_PERIOD);
+
+    // client manager sends through the reactor
+    this->mngClient.setReactor(this->reactor.get());
+    this->mngClient.setShards(this->shards, this->shardId);
 }
 
 
 /******************************************************************************
  *
- * 	First close sockets, then notify pinging thread.
+ * 	Adopt clients, who are still in mailbox, then close sockets.
  *
  */
 void Server::shutdown() {
     logger->info("Server shutting down.");
 
+    // clients handed over in the meantime are also told about shutdown
+    this->adoptClients();
     this->closeSockets();
-    this->cv.notify_one();
 }
 
 
@@ -137,117 +187,163 @@ void Server::shutdown() {
 
 /******************************************************************************
  *
- *  Accept new client connection, if max capacity is reached, refuse last connected client.
- *  Loop over all connected clients. Check for changes on except file descriptor
- *  and read file descriptor.
- *  If there is change on read file descriptor, try to read message of client and serve,
- *  if there is something in buffer, or if there is nothing in buffer,
- *  it means, that client logged out.
+ *  Accept new client connections, if server socket is ready or was not drained.
+ *  Close or erase clients, which were flagged since last update.
+ *  Loop over sockets, which reactor returned as ready. Check for changes on except
+ *  and read flag.
+ *  If socket is readable, read message of client and serve whole requests,
+ *  unfinished one waits in client's ring buffer for the rest. If client
+ *  closed the connection, it means, that client logged out.
  *  During errors, disconnect client.
+ *  Output queued during the update is sent at its end, once per client.
  *
  */
-void Server::updateClients(fd_set& fds_read, fd_set& fds_except) {
+void Server::updateClients() {
     int received = 0;
-    int client_socket = 0;
 
     // server socket -- request for new connection
-    if (FD_ISSET(this->serverSocket, &fds_read)) {
-        this->acceptConnection();
-    }
-
-    // check if capacity for connected clients is not full
-    if (this->mngClient.getCountClients() == this->maxClients) {
-        // if there are disconnected clients
-        if (this->mngClient.isDisconnectedClient()) {
-            // erase longest disconnected one
-            this->mngClient.eraseLongestDisconnectedClient();
+    for (const auto& ev : this->events) {
+        // reactor already accepted the connection
+        if (ev.flags & R_Accept) {
+            this->registerConnection(ev.fd, getPeerAddress(ev.fd));
+        }
+        else if (ev.fd == this->serverSocket) {
+            this->acceptPending = true;
+        }
+        // other shard handed some clients over
+        else if (ev.fd == this->shards->getMailbox(this->shardId).getFd()) {
+            this->adoptClients();
         }
-        // else refuse just connected client
-        else {
-            this->refuseConnection();
+        // heartbeats
+        else if (ev.fd == this->wheel->getFd()) {
+            this->acceptBlocked = false;
+            this->expireTimers();
         }
     }
 
-    // loop over all connected clients
-    for (auto cli = this->mngClient.getVectorOfClients().begin();
-              cli != this->mngClient.getVectorOfClients().end();
-              /* Increment after erasing client or at the end of loop. */ ) {
+    // accept new connections (also those, which did not fit to budget of last tick)
+    if (this->acceptPending && !this->acceptBlocked) {
+        this->acceptConnection();
+    }
 
-        // --- changes from pinging thread START
+    // changes from heartbeats or from reconnection
+    if (this->mngClient.takeFlagged()) {
+        this->updateFlaggedClients();
+    }
 
-        // check is client's connection is ready to disconnect
-        if (cli->getFlagToDisconnect()) {
-            this->closeConnection(cli, cli->getReason());
-            // client's connection was closed, so set flag to false
-            cli->setFlagToDisconnect(false, "closed");
-            continue;
-        }
-        // check is client's instance is ready to erase
-        if (cli->getFlagToErase()) {
-            cli = this->mngClient.eraseClient(cli);
+    // loop over ready sockets only
+    for (const auto& ev : this->events) {
+        if (ev.fd == this->serverSocket || (ev.flags & R_Accept) || ev.fd == this->shards->getMailbox(this->shardId).getFd()
+                || ev.fd == this->wheel->getFd()) {
             continue;
         }
 
-        // --- changes from pinging thread END
+        // client on actual ready socket (might have been closed in the meantime)
+        auto cli = this->mngClient.findClientBySocket(ev.fd);
 
-        // socket of actual iterated client
-        client_socket = cli->getSocket();
-
-        if (client_socket < 0) {
-            ++cli;
+        if (cli == this->mngClient.getClients().end()) {
             continue;
         }
 
         // except file descriptor change
-        if (FD_ISSET(client_socket, &fds_except)) {
+        if (ev.flags & R_Except) {
             this->closeConnection(cli, "except file descriptor error");
             continue;
         }
 
-        // read file descriptor change
-        if (FD_ISSET(client_socket, &fds_read)) {
-            ioctl(client_socket, FIONREAD, &received);
+        // socket takes data again, so send what it did not take before
+        if ((ev.flags & R_Write) && !cli->getOutbox().isEmpty()) {
+            this->mngClient.flushClient(*cli);
+        }
+
+        // read file descriptor change, or data already received by reactor
+        if (ev.flags & (R_Read | R_Data)) {
+            received = (ev.flags & R_Data) ? this->takeClientData(*cli, ev) : this->readClient(*cli);
+
+            // bad socket
+            if (received < 0) {
+                this->closeConnection(cli, "no message received");
+                continue;
+            }
 
-            // if there is something in receive buffer, read
-            if (received > 0) {
-                // this variable may change to non-zero value according to what is client sending
-                received = this->readClient(client_socket);
+            // serve whole requests
+            if (!this->buffer.empty()) {
+                this->processBuffer(cli);
 
-                // successful message receive
-                if (received > 0) {
-                    if (this->serveClient(*cli) != 0) {
-                        // message about too many connections
-                        this->mngClient.sendToClient(*cli, Protocol::SC_KICK);
+                // client might have been kicked or handed over
+                cli = this->mngClient.findClientBySocket(ev.fd);
 
-                        this->closeConnection(cli, "violation of protocol");
-                        continue;
-                    }
+                if (cli == this->mngClient.getClients().end()) {
+                    continue;
                 }
             }
 
-            // client logout
-            if (received == 0) {
+            // client logout (after everything sent before was served)
+            if (cli->getRing().isClosed()) {
                 this->closeConnection(cli, "logout");
                 continue;
             }
-            // bad socket
-            else if (received < 0) {
-                this->closeConnection(cli, "no message received");
-                continue;
-            }
         }
+    }
+
+    // pair clients, who are Ready for a game
+    auto lonely = this->mngClient.moveReadyClientsToPlay();
 
-        ++cli;
+    // maybe there is opponent on other shard
+    if (this->shards->getCount() > 1) {
+        this->shareLonelyClient(lonely);
     }
 
-    // check clients, who are Waiting for a game
-    this->mngClient.moveReadyClientsToPlay();
+    // send everything queued during this tick, one send per client
+    this->mngClient.flushDirtyClients();
+}
+
+
+/******************************************************************************
+ *
+ *  Visit only clients flagged to close connection or to erase instance
+ *  and do so.
+ *
+ */
+void Server::updateFlaggedClients() {
+    ClientSlots& clients = this->mngClient.getClients();
+
+    // only flagged clients are visited, found in dense table of flags
+    for (auto cli = clients.findFlagged(clients.begin());
+              cli != clients.end();
+              cli = clients.findFlagged(cli)) {
+
+        // check is client's connection is ready to disconnect
+        if (cli->getFlagToDisconnect()) {
+            this->closeConnection(cli, cli->getReason());
+            // client's connection was closed, so set flag to false
+            cli->setFlagToDisconnect(false, D_Closed);
+            continue;
+        }
+        // check is client's instance is ready to erase
+        if (cli->getFlagToErase()) {
+            cli = this->mngClient.eraseClient(cli);
+            continue;
+        }
+    }
 }
 
 
 // ----- CLIENT MANAGING
 
 
+/******************************************************************************
+ *
+ *  Accept pending connections -- server socket is non-blocking and edge-triggered
+ *  reactor does not report it again, so it is accepted until it would block.
+ *  At most ACCEPT_BUDGET connections are accepted during one tick, the rest waits
+ *  for next tick, which comes right away, because the loop wakes itself.
+ *  When there are no descriptors or memory for new socket, the connections
+ *  stay pending and are accepted on next tick of wheel (not right away, that
+ *  would only spin the loop).
+ *  Address of peer comes from accept and new socket is non-blocking already.
+ *
+ */
 void Server::acceptConnection() {
     // client socket index for file descriptor.
     int client_socket = 0;
@@ -255,43 +351,207 @@ void Server::acceptConnection() {
     // address of incoming connection
     struct sockaddr_in peer_addr{};
     // length of address of incoming connection
-    socklen_t peer_addr_len{};
+    socklen_t peer_addr_len = 0;
+
+    for (int accepted = 0; accepted < ACCEPT_BUDGET; ++accepted) {
+        peer_addr_len = sizeof(peer_addr);
 
-    // accept new connection
-    client_socket = accept(this->serverSocket, (struct sockaddr*) &peer_addr, &peer_addr_len);
+        // accept new connection
+        client_socket = accept4(this->serverSocket, (struct sockaddr*) &peer_addr, &peer_addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
-    if (client_socket > 0) {
-        // get ip address of client
-        getpeername(client_socket, (struct sockaddr*) &peer_addr, &peer_addr_len);
+        if (client_socket < 0) {
+            // connection closed by peer before accepting, try next one
+            if (errno == ECONNABORTED || errno == EINTR) {
+                continue;
+            }
+            // no more pending connections
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                this->acceptPending = false;
+                return;
+            }
 
-        // set new connection to file descriptor
-        FD_SET(client_socket, &(this->sockets));
+            // edge-triggered socket would not be reported again, so connections stay pending
+            logger->error("New connection could not be established [%s].", std::strerror(errno));
 
-        // create client instance
-        this->mngClient.createClient(inet_ntoa(peer_addr.sin_addr), client_socket);
+            this->acceptBlocked = true;
+            return;
+        }
 
-        logger->info("New connection on socket [%d] established.", client_socket);
+        this->registerConnection(client_socket, peer_addr.sin_addr.s_addr);
     }
-    else {
-        logger->error("New connection on socket [%s] could not be established.", std::strerror(errno));
+
+    // budget is spent, but there might be more connections
+    this->shards->getMailbox(this->shardId).wake();
+}
+
+
+void Server::registerConnection(const int& client_socket, const std::uint32_t& ip) {
+    // check if capacity for connected clients is not full
+    if (!this->admitConnection(client_socket)) {
+        return;
+    }
+
+    int nodelay = 1;
+
+    // output is coalesced per tick already, so Nagle would only hold the last frame back
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    // set new connection to reactor
+    if (!this->reactor->add(client_socket, W_Connection)) {
+        close(client_socket);
+        return;
+    }
+
+    // create client instance
+    auto cli = this->mngClient.createClient(ip, client_socket);
+
+    this->startHeartbeat(*cli);
+
+    logger->info("New connection on socket [%d] established.", client_socket);
+}
+
+
+/******************************************************************************
+ *
+ *  Reactor, which accepts connections itself, does not give their addresses,
+ *  so ask for it.
+ *
+ */
+std::uint32_t Server::getPeerAddress(const int& sock) {
+    struct sockaddr_in peer_addr{};
+    socklen_t peer_addr_len = sizeof(peer_addr);
+
+    // 0.0.0.0, when peer is not known
+    if (getpeername(sock, (struct sockaddr*) &peer_addr, &peer_addr_len) != 0) {
+        return 0;
+    }
+
+    return peer_addr.sin_addr.s_addr;
+}
+
+
+/******************************************************************************
+ *
+ *  When server is full, free place after longest disconnected client, or refuse
+ *  new connection. Refused connection gets prepared "too many clients" frame
+ *  and is closed right away, so it costs neither client instance nor reactor.
+ *
+ */
+bool Server::admitConnection(const int& client_socket) {
+    if (this->mngClient.getCountClients() < this->maxClients) {
+        return true;
+    }
+
+    // if there are disconnected clients, erase longest disconnected one
+    if (this->mngClient.isDisconnectedClient()) {
+        this->mngClient.eraseLongestDisconnectedClient();
+        return true;
+    }
+
+    // socket is new, so short message fits to it
+    (void) !send(client_socket, Protocol::FRAME_MANY_CLNT.data(), Protocol::FRAME_MANY_CLNT.length(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    close(client_socket);
+
+    this->connShed += 1;
+
+    logger->trace("Refused connection on socket [%d], server is full.", client_socket);
+
+    return false;
+}
+
+
+/******************************************************************************
+ *
+ *  Adopt clients from mailbox of this shard -- watch their sockets
+ *  and serve requests, which the other shard did not serve.
+ *
+ */
+void Server::adoptClients() {
+    Mailbox& mailbox = this->shards->getMailbox(this->shardId);
+    Letter* letter = nullptr;
+
+    mailbox.drain();
+
+    while ((letter = mailbox.take()) != nullptr) {
+        int sock = letter->client.getSocket();
+
+        if (!this->reactor->add(sock, W_Connection)) {
+            close(sock);
+            delete letter;
+            continue;
+        }
+
+        auto cli = this->mngClient.adoptClient(letter->client, letter->nick, letter->readySince);
+
+        logger->info("Client [%s] on socket [%d] adopted by shard [%d].", cli->getNick().c_str(), sock, this->shardId);
+
+        this->startHeartbeat(*cli);
+
+        if (!cli->getOutbox().isEmpty()) {
+            this->mngClient.flushClient(*cli);
+        }
+
+        if (!letter->rest.empty()) {
+            this->buffer = letter->rest;
+            this->processBuffer(cli);
+        }
+
+        delete letter;
     }
 }
 
 
-void Server::refuseConnection() {
-    // new connected client
-    auto newClient = this->mngClient.getVectorOfClients().end() - 1;
-    int newClient_sock = newClient->getSocket();
+/******************************************************************************
+ *
+ *  Stop watching client's socket and move client to other shard's mailbox.
+ *
+ */
+void Server::handOver(clientsIterator& client, const int& shard, const std::string& rest) {
+    int sock = client->getSocket();
+
+    // what socket does not take now, moves with client
+    this->reactor->flush(sock, client->getOutbox());
+
+    // reactor may keep the socket for its output in flight and give other shard its duplicate
+    int moved = this->reactor->handOver(sock);
 
-    // message about too many connections
-    this->mngClient.sendToClient(*newClient, Protocol::SC_MANY_CLNT);
+    if (moved < 0) {
+        client->setShardToMove(-1);
+        client->setFlagToDisconnect(true, D_HandoverFailed);
+        this->mngClient.markFlagged();
+        return;
+    }
 
-    // close connection
-    this->closeConnection(newClient, "server is full");
-    // and erase the instance
-    this->mngClient.eraseClient(newClient);
+    logger->info("Client [%s] on socket [%d] handed over to shard [%d] as socket [%d].", client->getNick().c_str(), sock, shard, moved);
+
+    // nick (if any) belongs to the other shard from now
+    if (!client->getNick().empty()) {
+        this->shards->moveNick(client->getNick(), shard);
+    }
 
-    logger->info("Refused client on socket [%d].", newClient_sock);
+    auto* letter = new Letter(*client, client->getNick(), this->mngClient.getClients().getTable().getReadySince(client.getIndex()), rest);
+    letter->client.setShardToMove(-1);
+    letter->client.setSocket(moved);
+    // copy does not belong to slot map of this shard
+    letter->client.setTable(nullptr, -1);
+
+    this->mngClient.detachClient(client);
+    this->shards->getMailbox(shard).post(letter);
+}
+
+
+void Server::shareLonelyClient(clientsIterator& lonely) {
+    if (lonely == this->mngClient.getClients().end()) {
+        this->shards->withdrawLonely(this->shardId);
+        return;
+    }
+
+    int shard = this->shards->offerLonely(this->shardId);
+
+    // other shard has lonely client too, so move this one there
+    if (shard >= 0) {
+        this->handOver(lonely, shard, "");
+    }
 }
 
 
@@ -303,12 +563,15 @@ void Server::closeConnection(clientsIterator& client, const char* reason) {
         return;
     }
 
-    // server remove connection
-    FD_CLR(client->getSocket(), &(this->sockets));
-    // close socket
-    close(client->getSocket());
+    // last chance for queued output (eg. kick message)
+    this->reactor->flushLast(client->getSocket(), client->getOutbox());
+    // server remove connection and close socket
+    this->reactor->closeSocket(client->getSocket());
+    // unfinished request will never be finished, nor will be sent the rest of output
+    client->getRing().clear();
+    client->getOutbox().clear();
 
-    logger->info("Client [%s] with ip [%s] on socket [%d] closed [%s]", client->getNick().c_str(), client->getIpAddr().c_str(), client->getSocket(), reason);
+    logger->info("Client [%s] with ip [%s] on socket [%d] closed [%s]", client->getNick().c_str(), client->toStringIpAddr().c_str(), client->getSocket(), reason);
 
     // this will disconnect client also in server logic, but will keep the instance, so client is able to reconnect
     // state to disconnected
@@ -320,63 +583,124 @@ void Server::closeConnection(clientsIterator& client, const char* reason) {
 
     // if client was playing, send massage to opponent about disconnection
     if (stateLast == PlayingOnTurn || stateLast == PlayingOnStand) {
-        this->mngClient.sendToOpponentOf(*client, Protocol::SC_OPN_DISC);
+        this->mngClient.sendToOpponentOf(*client, Protocol::FRAME_OPN_DISC);
     }
 }
 
 
 /******************************************************************************
  *
- *  Read while there is something in buffer to read or while class buffer is not full.
- *  If class buffer is full, disconnect client, because client is flooding the server.
+ *  Receive everything client sent directly to client's ring buffer and take
+ *  whole requests out of it. If ring buffer is full, disconnect client,
+ *  because client is flooding the server.
  *
  */
-int Server::readClient(const int& sock) {
-    int in_buffer = 0;
-    int received = 0;
-    int received_total = 0;
-
-    // local step buffer receiving possible not whole data
-    char step_buffer[SIZE_BUFF]{'\0'};
-    // clear server's buffer
-    this->clearBuffer(this->buffer);
-
-    while(1) {
-        ioctl(sock, FIONREAD, &in_buffer);
-
-        // something is still there to read
-        if (in_buffer > 0) {
-            received = recv(sock, step_buffer, SIZE_RECV, 0);
-
-            // read from client, until buffer is full
-            if (received_total < SIZE_RECV - LONGEST_MSG && received >= 0) {
-                // increment total received bytes in this reading from socket
-                received_total += received;
-                // increment total received bytes in server lifetime (even during flooding)
-                this->bytesRecv += received_total;
-
-                // copy step buffer to class buffer
-                this->insertToBuffer(this->buffer, step_buffer);
-                this->clearBuffer(step_buffer);
-            }
-        }
-        // end of receiving
-        else if (in_buffer == 0) {
-            logger->trace("End of receiving from client on socket [%d], in buffer: [%s]", sock, this->buffer);
-            break;
+int Server::readClient(Client& client) {
+    int received = client.getRing().receive(client.getSocket());
+
+    if (received < 0) {
+        if (client.getRing().isFull()) {
+            logger->warning("Server is being flooded. Going to disconnect client on socket [%d].", client.getSocket());
         }
 
-        // client is flooding the server (not possible to fill 1KB buffer
-        // during turn-based game, with used protocol, like this one)
-        if (received_total > SIZE_RECV - LONGEST_MSG || in_buffer < 0 || received < 0) {
-            received_total = -1;
+        return -1;
+    }
 
-            logger->warning("Server is being flooded. Going to disconnect client on socket [%d].", sock);
-            break;
-        }
+    // increment total received bytes in server lifetime
+    this->bytesRecv += received;
+
+    if (this->takeRequests(client) < 0) {
+        return -1;
+    }
+
+    logger->trace("End of receiving from client on socket [%d], in buffer: [%s]", client.getSocket(), this->buffer.c_str());
+
+    return received;
+}
+
+
+/******************************************************************************
+ *
+ *  Serve message in class buffer. Kick client, who violates protocol,
+ *  and hand over client, who belongs to other shard.
+ *
+ */
+void Server::processBuffer(clientsIterator& client) {
+    std::string rest;
+    int served = this->serveClient(*client, rest);
+
+    if (served < 0) {
+        // message about violation of protocol
+        this->mngClient.sendToClient(*client, Protocol::FRAME_KICK);
+
+        this->closeConnection(client, "violation of protocol");
     }
+    else if (served > 0) {
+        // copy, because client is detached during handover
+        int shard = client->getShardToMove();
 
-    return received_total;
+        this->handOver(client, shard, rest);
+    }
+}
+
+
+/******************************************************************************
+ *
+ *  Copy data received by reactor to client's ring buffer and take whole
+ *  requests out of it. Same limit as in readClient() applies.
+ *
+ */
+int Server::takeClientData(Client& client, const ReactorEvent& ev) {
+    // reactor received end of connection
+    if (ev.len == 0) {
+        client.getRing().markClosed();
+        this->buffer.clear();
+        return 0;
+    }
+
+    if (!client.getRing().write(ev.data, ev.len)) {
+        logger->warning("Server is being flooded. Going to disconnect client on socket [%d].", ev.fd);
+        return -1;
+    }
+
+    this->bytesRecv += ev.len;
+
+    if (this->takeRequests(client) < 0) {
+        return -1;
+    }
+
+    logger->trace("End of receiving from client on socket [%d], in buffer: [%s]", ev.fd, this->buffer.c_str());
+
+    return ev.len;
+}
+
+
+/******************************************************************************
+ *
+ *  Requests of client talking binary protocol are transcoded to text frames,
+ *  so both protocols are served the same way. Client, who sent invalid binary
+ *  message, is kicked (returns -1).
+ *
+ */
+int Server::takeRequests(Client& client) {
+    if (!client.isBinary()) {
+        client.getRing().takeFrames(this->buffer);
+        return 0;
+    }
+
+    client.getRing().takeMessages(this->messages);
+    this->buffer.clear();
+
+    if (decodeMessages(this->messages, this->buffer) != 0) {
+        logger->warning("Server received invalid binary data from socket [%d].", client.getSocket());
+
+        this->buffer.clear();
+        this->mngClient.sendToClient(client, Protocol::FRAME_KICK);
+
+        return -1;
+    }
+
+    return 0;
 }
 
 
@@ -384,26 +708,39 @@ int Server::readClient(const int& sock) {
  *
  * Check if received data are valid, parse the data and then pass it to ClientManager to process it.
  * If client was successfully served, returns 0, else return -1.
+ * If client has to be handed over to other shard, returns 1 and requests,
+ * which were not served, are in given string.
  *
  */
-int Server::serveClient(Client& client) {
+int Server::serveClient(Client& client, std::string& rest) {
     // according to C standards, it is better to return 0 on success,
     // so this code doesn't give headaches on return values
     int valid = 0;
-    clientData data = clientData();
 
-    // if message had valid format, parse it
-    if (isValidFormat(this->buffer) == 0) {
-        parseMsg(this->buffer, data);
-    }
-    else {
-        valid = 1;
+    // check format of message and split it to requests in one pass
+    if (parseMsg(this->buffer, this->requests) != 0) {
+        valid = -1;
         logger->warning("Server received invalid data from socket [%d].", client.getSocket());
     }
 
     // always should be true, when message is in valid format
-    if (!data.empty()) {
-        valid = this->mngClient.process(client, data);
+    if (!this->requests.empty()) {
+        valid = this->mngClient.process(client, this->requests);
+    }
+
+    // put requests for other shard back to protocol format
+    if (valid == 1) {
+        for (const auto& rqst : this->requests) {
+            rest += Protocol::OP_SOH;
+            rest += rqst.key;
+
+            if (!rqst.value.empty()) {
+                rest += Protocol::OP_INI;
+                rest += rqst.value;
+            }
+
+            rest += Protocol::OP_EOT;
+        }
     }
 
     return valid;
@@ -412,86 +749,115 @@ int Server::serveClient(Client& client) {
 
 /******************************************************************************
  *
- * 	Called by pinging thread to ping clients.
+ * 	First heartbeat of client comes after at least half of ping period, the rest
+ * 	is given by its timer key, so clients connected at once are not pinged at once.
  *
  */
-void Server::pingClients() {
-    while (isRunning) {
-        std::unique_lock<std::mutex> lock(mtx);
+void Server::startHeartbeat(const Client& client) {
+    unsigned spread = (unsigned) client.getTimerKey() * 2654435761u % (PING_PERIOD / 2);
 
-        State state, stateLast;
+    this->wheel->schedule(client.getTimerKey(), PING_PERIOD / 2 + spread);
+}
 
-        // print statistics about clients
-        logger->debug("%s", this->mngClient.toStringAllClients().c_str());
 
-        // ping all clients and disconnect those, who can't answer immediately
-        for (auto client = this->mngClient.getVectorOfClients().begin();
-                  client != this->mngClient.getVectorOfClients().end();
-                  ++client
-                  /** increment in `if`, second `else if` and at the end of loop */) {
+/******************************************************************************
+ *
+ * 	Serve timers expired since last tick. Every client has its own heartbeat
+ * 	timer, which is scheduled again after each beat, until client is erased.
+ *
+ */
+void Server::expireTimers() {
+    this->wheel->expire(this->expired);
 
-            logger->trace("PING: socket [%d] nick [%s] state [%s].", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
+    for (const auto& key : this->expired) {
+        // print statistics about clients
+        if (key == STATS_TIMER) {
+            logger->debug("%s", this->mngClient.toStringAllClients().c_str());
+            this->wheel->schedule(STATS_TIMER, PING_PERIOD);
+            continue;
+        }
 
-            state = client->getState();
+        auto client = this->mngClient.findClientByTimerKey(key);
 
-            // erase client if one is without name, in order to prevent useless instances on server,
-            // but dont do that, if instance was disconnected already -- condition for socket > 0
-            if (client->getState() != New && client->getNick() == "" && client->getSocket() > 0) {
-                client->setFlagToDisconnect(true, "useless instance");
-                client->setFlagToErase(true);
-                continue;
-            }
+        // client was erased or handed over in the meantime
+        if (client == this->mngClient.getClients().end()) {
+            continue;
+        }
 
-            // if client was already pinged and did not respond with pong since, mark one as Lost
-            if (state == Pinged) {
-                logger->trace("Socket [%d] nick [%s] state [%s] -> setting to Lost.", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
+        this->heartbeat(client);
 
-                this->mngClient.sendToClient(*client, Protocol::OP_PING);
-                client->setState(Lost);
+        if (!client->getFlagToErase()) {
+            this->wheel->schedule(key, PING_PERIOD);
+        }
+    }
+}
 
-                stateLast = client->getStateLast();
 
-                // if stateLast was Playing*, send massage to opponent about Lost
-                if (stateLast == PlayingOnTurn || stateLast == PlayingOnStand) {
-                    this->mngClient.sendToOpponentOf(*client, Protocol::SC_OPN_LOST);
-                }
-            }
+/******************************************************************************
+ *
+ * 	Ping client and disconnect one, who can't answer until next heartbeat.
+ *
+ */
+void Server::heartbeat(clientsIterator& client) {
+    State state = client->getState();
+    State stateLast;
+
+    logger->trace("PING: socket [%d] nick [%s] state [%s].", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
+
+    // erase client if one is without name, in order to prevent useless instances on server,
+    // but dont do that, if instance was disconnected already -- condition for socket > 0
+    if (state != New && client->getNick() == "" && client->getSocket() > 0) {
+        client->setFlagToDisconnect(true, D_UselessInstance);
+        client->setFlagToErase(true);
+        this->mngClient.markFlagged();
+    }
 
-            // if client was Lost and did not respond since with reconnect request,
-            // client is considered as "not responding"
-            else if (state == Lost) {
-                logger->trace("Socket [%d] nick [%s] state [%s] -> closing.", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
+    // if client was already pinged and did not respond with pong since, mark one as Lost
+    else if (state == Pinged) {
+        logger->trace("Socket [%d] nick [%s] state [%s] -> setting to Lost.", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
 
-                this->mngClient.sendToClient(*client, Protocol::SC_KICK);
-                client->setFlagToDisconnect(true, "not responding");
-            }
+        this->mngClient.sendToClient(*client, Protocol::FRAME_PING);
+        client->setState(Lost);
 
-            // long inaccessibility
-            else if (state == Disconnected) {
-                // decrease inaccessibility counter during each ping
-                client->decreaseInaccessCount();
+        stateLast = client->getStateLast();
 
-                // if counter reached 0, disconnect totally
-                if (client->getInaccessCount() == 0) {
-                    client->setFlagToErase(true);
-                    continue;
-                }
+        // if stateLast was Playing*, send massage to opponent about Lost
+        if (stateLast == PlayingOnTurn || stateLast == PlayingOnStand) {
+            this->mngClient.sendToOpponentOf(*client, Protocol::FRAME_OPN_LOST);
+        }
+    }
 
-                logger->trace("Client with nick [%s] state [%s] is being decreased [%d].", client->getNick().c_str(), client->toStringState().c_str(), client->getInaccessCount());
-            }
+    // if client was Lost and did not respond since with reconnect request,
+    // client is considered as "not responding"
+    else if (state == Lost) {
+        logger->trace("Socket [%d] nick [%s] state [%s] -> closing.", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
 
-            // send ping message to client
-            else {
-                logger->trace("Socket [%d] nick [%s] state [%s] -> pinging.", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
+        this->mngClient.sendToClient(*client, Protocol::FRAME_KICK);
+        client->setFlagToDisconnect(true, D_NotResponding);
+        this->mngClient.markFlagged();
+    }
 
-                this->mngClient.sendToClient(*client, Protocol::OP_PING);
-                client->setState(Pinged);
-            }
+    // long inaccessibility
+    else if (state == Disconnected) {
+        // decrease inaccessibility counter during each ping
+        client->decreaseInaccessCount();
 
-//            ++client;
+        // if counter reached 0, disconnect totally
+        if (client->getInaccessCount() == 0) {
+            client->setFlagToErase(true);
+            this->mngClient.markFlagged();
+            return;
         }
 
-        this->cv.wait_for(lock, std::chrono::milliseconds(PING_PERIOD));
+        logger->trace("Client with nick [%s] state [%s] is being decreased [%d].", client->getNick().c_str(), client->toStringState().c_str(), client->getInaccessCount());
+    }
+
+    // send ping message to client
+    else {
+        logger->trace("Socket [%d] nick [%s] state [%s] -> pinging.", client->getSocket(), client->getNick().c_str(), client->toStringState().c_str());
+
+        this->mngClient.sendToClient(*client, Protocol::FRAME_PING);
+        client->setState(Pinged);
     }
 }
 
@@ -506,12 +872,12 @@ void Server::closeSockets() {
 
 
 void Server::closeClientSockets() {
-    for (auto client = this->mngClient.getVectorOfClients().begin();
-              client != this->mngClient.getVectorOfClients().end();
+    for (auto client = this->mngClient.getClients().begin();
+              client != this->mngClient.getClients().end();
               /* incremented by erase() */) {
 
         // message about server shutdown
-        this->mngClient.sendToClient(*client, Protocol::SC_SHDW);
+        this->mngClient.sendToClient(*client, Protocol::FRAME_SHDW);
 
         // close connection of client
         this->closeConnection(client, "Server shutdown.");
@@ -524,32 +890,13 @@ void Server::closeClientSockets() {
 
 
 void Server::closeServerSocket() {
+    this->reactor->remove(this->serverSocket);
     close(this->serverSocket);
-    FD_CLR(this->serverSocket, &(this->sockets));
 
     logger->info("Server socket closed.");
 }
 
 
-// ----- OTHERS
-
-
-void Server::clearBuffer(char* p_buff) {
-    std::memset(p_buff, 0, SIZE_BUFF);
-}
-
-
-void Server::insertToBuffer(char* p_dst, char* p_src) {
-    // copy everything, except newline characters, from source to destination
-    while (*p_src) {
-        if (!(*p_src == '\n' || *p_src == '\r')) {
-            *p_dst = *p_src;
-            ++p_dst;
-        }
-        ++p_src;
-    }
-}
-
 
 
 
@@ -561,92 +908,65 @@ void Server::insertToBuffer(char* p_dst, char* p_src) {
 
 /******************************************************************************
  *
- * 	Set running flag to 1, start pinging thread and enter main server loop.
- * 	Make copy of main file descriptor made during initialization.
- * 	Wait on select for changes and then either break or update clients.
- * 	Breaks out only after CTRL+C or error on select.
- * 	After loop, safely shutdown -- close all sockets and notify pinging thread,
- * 	which is also joined in the end.
- * 	If server broke out from loop, because of error on select, throw an exception.
+ * 	Set running flag to 1 and enter main server loop.
+ * 	Wait on reactor for changes and then either break or update clients.
+ * 	Clients are pinged from the loop too, when their heartbeat timers expire.
+ * 	Breaks out only after CTRL+C or error on reactor.
+ * 	After loop, safely shutdown -- close all sockets.
+ * 	If server broke out from loop, because of error on reactor, throw an exception.
  *
  */
 void Server::run() {
-    // return value of select
+    // return value of reactor
     int activity = 0;
     int crash = 0;
 
-    // sockets for comparing changes on sockets
-    fd_set fdsRead{}, fdsExcept{};
-
-    // time structure for timeout
-    struct timeval tv{};
-    tv.tv_sec = TIMEOUT_SEC;
-    tv.tv_usec = TIMEOUT_USEC;
-
     // set server as running (this is inline volatile std::sig_atomic_t variable in signal.hpp)
     isRunning = 1;
 
-    // create pinging thread
-    std::thread pingThread(&Server::pingClients, this);
-
     while (isRunning) {
-        // create copy of client sockets, in order to compare it after select
-        fdsRead   = sockets;
-        fdsExcept = sockets;
-
-        // reset timeout time
-        tv.tv_sec = TIMEOUT_SEC;
-        tv.tv_usec = TIMEOUT_USEC;
-
-        // if still running, call 'select' which finds out, if there were some changes on file descriptors
+        // if still running, wait on reactor, which finds out, if there were some changes on file descriptors
         if (isRunning) {
-            activity = select(FD_SETSIZE, &fdsRead, nullptr, &fdsExcept, &tv);
+            activity = this->reactor->wait(this->events, TIMEOUT_MSEC);
         }
 
-        // Server most of the time waits on select() above and when SIGINT signal comes,
+        // Server most of the time waits on reactor above and when SIGINT signal comes,
         // it is caught by signalHandler() in main.cpp, which sets the isRunning variable to 0.
-        // Then select() is released, so this condition breaks the loop, in order to
+        // Then reactor is released, so this condition breaks the loop, in order to
         // the server may shutdown properly
         if (isRunning == 0) {
             break;
         }
 
-        // crash server after error on select
+        // crash server after error on reactor
         if (activity < 0) {
             isRunning = 0;
             crash = 1;
             break;
         }
 
-        // update clients -- accept, recv
-        {
-            const std::lock_guard<std::mutex> lock(this->mtx);
-            this->updateClients(fdsRead, fdsExcept);
-        }
+        // update clients -- accept, recv, heartbeats (only this thread touches them)
+        this->updateClients();
     }
 
     // safely shutdown server
-    {
-        const std::lock_guard<std::mutex> lock(this->mtx);
-        this->shutdown();
-    }
-
-    pingThread.join();
+    this->shutdown();
 
     if (crash) {
-        throw std::runtime_error(std::string("select is negative.."));
+        throw std::runtime_error(std::string("reactor wait is negative.."));
     }
 }
 
 
 void Server::prStats() {
-    logger->info("--- Printing statistics ---");
+    logger->info("--- Printing statistics of shard [%d] ---", this->shardId);
     logger->info("Clients connected: %d",    this->mngClient.getCountConnected());
     logger->info("Clients disconnected: %d", this->mngClient.getCountDisconnected());
     logger->info("Clients reconnected: %d",  this->mngClient.getCountReconnected());
     logger->info("Game rooms created: %d",   this->mngClient.getRoomsTotal());
     logger->info("Bytes received: %d",       this->bytesRecv);
     logger->info("Bytes sent: %d",           this->mngClient.getBytesSend());
+    logger->info("Connections shed: %d",     this->connShed);
     logger->info("--- Printing statistics --- DONE");
 }
 
@@ -663,9 +983,17 @@ int Server::getPort() {
 }
 
 int Server::getMaxClients() {
-    return this->maxClients - 1;
+    return this->maxClients;
 }
 
 int Server::getMaxRooms() {
     return this->maxRooms;
 }
+
+const char* Server::getBackend() {
+    return this->reactor->getName();
+}
+
+int Server::getShardId() {
+    return this->shardId;
+}
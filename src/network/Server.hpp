@@ -4,82 +4,120 @@
 // sockaddr_in
 #include <netinet/in.h>
 
-#include <condition_variable>
-#include <mutex>
+#include <cstdint>
+#include <memory>
 
 #include "ClientManager.hpp"
+#include "Reactor.hpp"
+#include "Shards.hpp"
+#include "TimerWheel.hpp"
 
 
 class Server {
 private:
     // --- ATTRIBUTES ---
 
-    /** Default size of queue for new connections. */
-    constexpr static const int BACK_LOG = 5;
+    /** Most connections accepted during one tick, so clients already connected are not starved. */
+    constexpr static const int ACCEPT_BUDGET = 64;
     /** Default size of buffer. */
     constexpr static const int SIZE_BUFF = 1024;
-    /** Default length of messages for receiving. */
-    constexpr static const int SIZE_RECV = SIZE_BUFF - 1;
-    /** Longest valid message server may accept (chat). */
-    constexpr static const int LONGEST_MSG = 106;
     /** Ping messages period in milliseconds. */
     constexpr static const int PING_PERIOD = 10000;
-    /** Seconds before timeout = PING_PERIOD - 1 seconds.*/
-    constexpr static const int TIMEOUT_SEC = (int) (PING_PERIOD/1000) - 1;
-    /** Microseconds before timeout. */
-    constexpr static const int TIMEOUT_USEC = 1;
+    /** Milliseconds before timeout = PING_PERIOD - 1 second. */
+    constexpr static const int TIMEOUT_MSEC = PING_PERIOD - 1000;
+    /** Length of one tick of timer wheel in milliseconds. */
+    constexpr static const int TICK_MSEC = 100;
+    /** Key of timer for printing statistics about clients (client timers are not negative). */
+    constexpr static const int STATS_TIMER = -1;
 
     /** Manages connected clients. */
     ClientManager mngClient;
 
-    /** Mutex for pinging thread -- vector of clients is critical section. */
-    std::mutex mtx;
-    /** Condition variable for pinging thread. Release after PING_PERIOD milliseconds. */
-    std::condition_variable cv;
+    /** All shards (reactor threads) of the server. */
+    Shards* shards;
+    /** Id of this shard. */
+    int shardId;
 
-    /** Maximum count of connected clients. One extra for the one client,
-     * who reaches maximum capacity and is disconnected after "max capacity" message. */
+    /** Maximum count of clients (also disconnected ones, who may reconnect). */
     int maxClients;
     /** Maximum count of game rooms. */
     int maxRooms;
 
-    /** Sockets for select. */
-    fd_set sockets{};
+    /** Event loop backend watching sockets. */
+    std::unique_ptr<Reactor> reactor;
+    /** Sockets with changes after last wait of reactor. */
+    std::vector<ReactorEvent> events;
+    /** Heartbeat timers of clients, ticking in the loop. */
+    std::unique_ptr<TimerWheel> wheel;
+    /** Keys of timers expired during last tick. */
+    std::vector<int> expired;
     /** Server address. */
     struct sockaddr_in serverAddress{};
     /** Server socket index for file descriptor. */
     int serverSocket;
-
-    /** Buffer for receiving messages. */
-    char buffer[SIZE_BUFF]{};
+    /** Server socket has connections, which were not accepted yet. */
+    bool acceptPending;
+    /** Accepting failed for lack of resources, it is tried again on next tick of wheel. */
+    bool acceptBlocked;
+
+    /** Whole requests of client, which is being served. */
+    std::string buffer;
+    /** Requests parsed from buffer (views into it, reused for every client). */
+    clientData requests;
+    /** Whole binary messages of client, which is being served (transcoded to buffer). */
+    std::string messages;
 
     /** Total received bytes. Server is only receiving. */
     int bytesRecv;
+    /** Count of connections refused, because server was full. */
+    int connShed;
 
     // --- METHODS ---
 
 	/** Initialize server. (called from constructor) */
-	void init(const char*, const int&);
+	void init(const char*, const int&, const char*, const int&);
 	/** Shutddown server. (called in Server::run() after while loop. */
 	void shutdown();
 
     /** Main loop for updating clients. */
-    void updateClients(fd_set&, fd_set&);
+    void updateClients();
+    /** Close or erase clients flagged by heartbeats or by reconnection. */
+    void updateFlaggedClients();
 
     /** Accept new client connections. */
 	void acceptConnection();
-	/** Refuse connection, when server is full. */
-	void refuseConnection();
+	/** Create client on new connection. */
+	void registerConnection(const int&, const std::uint32_t&);
+	/** Get IPv4 address of peer of connected socket (network byte order). */
+	static std::uint32_t getPeerAddress(const int&);
+	/** Free place for new client, or refuse connection, when max capacity is reached. */
+	bool admitConnection(const int&);
+	/** Take clients handed over from other shards. */
+	void adoptClients();
+	/** Hand client over to other shard. */
+	void handOver(clientsIterator&, const int&, const std::string&);
+	/** Offer Ready client without opponent to other shards. */
+	void shareLonelyClient(clientsIterator&);
 	/** Close client's connection. */
     void closeConnection(clientsIterator&, const char*);
 
 	/** Receive message from client. */
-	int readClient(const int&);
+	int readClient(Client&);
+	/** Take message from client, which reactor already received. */
+	int takeClientData(Client&, const ReactorEvent&);
+	/** Take whole requests from client's ring buffer to buffer. */
+	int takeRequests(Client&);
     /** Serve client according to received message. */
-    int serveClient(Client&);
+    int serveClient(Client&, std::string&);
+    /** Serve client and kick or hand over one, if needed. */
+    void processBuffer(clientsIterator&);
 
-    /** Asynchronous pinging clients. */
-    void pingClients();
+    /** Schedule first heartbeat of new client. */
+    void startHeartbeat(const Client&);
+    /** Serve expired timers. */
+    void expireTimers();
+    /** Ping client, or mark one as Lost or disconnect one according to state. */
+    void heartbeat(clientsIterator&);
 
     /** Calls methods to close both server and client sockets. */
     void closeSockets();
@@ -88,14 +126,9 @@ private:
     /** Close server socket. */
     void closeServerSocket();
 
-    /** Clear buffer for message receiving. */
-    void clearBuffer(char*);
-    /** Inserts part of received message from buffer in readClient() to class buffer. */
-    void insertToBuffer(char*, char*);
-
 public:
 	/** Constructor. */
-    Server(const char*, const int&, const int&, const int&);
+    Server(const char*, const int&, const int&, const int&, const char*, const int&, const int&, const bool&, Shards*, const int&);
 
     /** Runs server. */
     void run();
@@ -110,6 +143,10 @@ public:
     int getMaxClients();
     /** Get maximum count of game rooms on server. */
     int getMaxRooms();
+    /** Get name of event loop backend. */
+    const char* getBackend();
+    /** Get id of shard. */
+    int getShardId();
 };
 
 #endif
@@ -0,0 +1,166 @@
+#include "Shards.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+Shards::Shards(const int& count) {
+    this->mailboxes = std::vector<std::unique_ptr<Mailbox>>();
+
+    for (int i = 0; i < count; ++i) {
+        this->mailboxes.push_back(std::make_unique<Mailbox>());
+    }
+
+    this->nicks = std::unordered_map<std::string, int>();
+    this->tokens = std::unordered_map<std::uint64_t, std::string>();
+    this->lonely.store(-1);
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+int Shards::claimNick(const std::string& nick, const int& shard) {
+    // single shard owns everything
+    if (this->mailboxes.size() == 1) {
+        return shard;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mtxNicks);
+
+    // inserts only, if the nick is not there yet
+    return this->nicks.emplace(nick, shard).first->second;
+}
+
+
+void Shards::releaseNick(const std::string& nick, const int& shard) {
+    if (this->mailboxes.size() == 1) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mtxNicks);
+
+    auto owner = this->nicks.find(nick);
+
+    if (owner != this->nicks.end() && owner->second == shard) {
+        this->nicks.erase(owner);
+    }
+}
+
+
+void Shards::moveNick(const std::string& nick, const int& shard) {
+    if (this->mailboxes.size() == 1) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mtxNicks);
+
+    this->nicks[nick] = shard;
+}
+
+
+/******************************************************************************
+ *
+ * 	Session moves between shards together with its nick, so only nick
+ * 	is remembered for token and owner of the nick tells, where the session is.
+ *
+ */
+bool Shards::claimToken(const std::uint64_t& token, const std::string& nick) {
+    // single shard knows its tokens itself
+    if (this->mailboxes.size() == 1) {
+        return true;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mtxNicks);
+
+    return this->tokens.emplace(token, nick).second;
+}
+
+
+void Shards::releaseToken(const std::uint64_t& token) {
+    if (this->mailboxes.size() == 1) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mtxNicks);
+
+    this->tokens.erase(token);
+}
+
+
+int Shards::findToken(const std::uint64_t& token) {
+    if (this->mailboxes.size() == 1) {
+        return -1;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->mtxNicks);
+
+    auto session = this->tokens.find(token);
+
+    if (session == this->tokens.end()) {
+        return -1;
+    }
+
+    auto owner = this->nicks.find(session->second);
+
+    return owner == this->nicks.end() ? -1 : owner->second;
+}
+
+
+/******************************************************************************
+ *
+ * 	If no shard offers lonely client, this shard becomes the one.
+ * 	If other shard offers, its offer is taken and this shard should move
+ * 	its lonely client there.
+ *
+ */
+int Shards::offerLonely(const int& shard) {
+    int other = this->lonely.load();
+
+    if (this->mailboxes.size() == 1 || other == shard) {
+        return -1;
+    }
+
+    if (other == -1) {
+        this->lonely.compare_exchange_strong(other, shard);
+        return -1;
+    }
+
+    // somebody else might have taken the offer in the meantime
+    return this->lonely.compare_exchange_strong(other, -1) ? other : -1;
+}
+
+
+void Shards::withdrawLonely(const int& shard) {
+    int self = shard;
+
+    this->lonely.compare_exchange_strong(self, -1);
+}
+
+
+void Shards::wakeAll() {
+    for (auto& mailbox : this->mailboxes) {
+        mailbox->wake();
+    }
+}
+
+
+// ----- GETTERS
+
+
+int Shards::getCount() const {
+    return this->mailboxes.size();
+}
+
+Mailbox& Shards::getMailbox(const int& shard) {
+    return *this->mailboxes[shard];
+}
@@ -0,0 +1,72 @@
+#ifndef SHARDS_HPP
+#define SHARDS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Mailbox.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Shared context of all shards (reactor threads). Every shard has its own
+ * 	Server with listener, ClientManager and Lobby, so two opponents always have
+ * 	to be on the same shard. Clients are moved between shards through mailboxes:
+ * 	- client reconnecting on other shard is moved to the shard, which owns the nick,
+ * 	- client resuming session on other shard is moved to the shard, which owns
+ * 	  the nick of the session,
+ * 	- Ready client without opponent is moved to other shard with lonely Ready client.
+ *
+ */
+class Shards {
+private:
+    /** Mailbox of every shard. */
+    std::vector<std::unique_ptr<Mailbox>> mailboxes;
+
+    /** Nicks of clients and shards, which own them. Used only during connecting and erasing. */
+    std::unordered_map<std::string, int> nicks;
+    /** Nicks by session tokens of clients. Owner of token is owner of its nick. */
+    std::unordered_map<std::uint64_t, std::string> tokens;
+    /** Mutex for nicks and tokens. */
+    std::mutex mtxNicks;
+
+    /** Shard with Ready client without opponent (-1 == none). */
+    std::atomic<int> lonely;
+
+public:
+    explicit Shards(const int&);
+
+    /** Own the nick by shard, if nobody owns it yet. Returns owner of the nick. */
+    int claimNick(const std::string&, const int&);
+    /** Release the nick, if shard owns it. */
+    void releaseNick(const std::string&, const int&);
+    /** Give the nick to other shard. */
+    void moveNick(const std::string&, const int&);
+
+    /** Remember session token of the nick, if no other session has it. Returns false, if it is used. */
+    bool claimToken(const std::uint64_t&, const std::string&);
+    /** Forget session token. */
+    void releaseToken(const std::uint64_t&);
+    /** Shard, which owns nick of session token, or -1. */
+    int findToken(const std::uint64_t&);
+
+    /** Offer lonely Ready client of shard. Returns shard, where to move the client, or -1. */
+    int offerLonely(const int&);
+    /** Shard does not have lonely Ready client anymore. */
+    void withdrawLonely(const int&);
+
+    /** Wake every shard, eg. during shutdown. */
+    void wakeAll();
+
+    // getters
+    [[nodiscard]] int getCount() const;
+    Mailbox& getMailbox(const int&);
+};
+
+
+#endif
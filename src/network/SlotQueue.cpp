@@ -0,0 +1,88 @@
+#include "SlotQueue.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+SlotQueue::SlotQueue(const int& count) {
+    this->prev = std::vector<int>();
+    this->next = std::vector<int>();
+    this->lists = std::vector<int>();
+    this->heads = std::vector<int>(count, -1);
+    this->tails = std::vector<int>(count, -1);
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void SlotQueue::push(const int& slot, const int& list) {
+    if (slot >= (int) this->next.size()) {
+        this->prev.resize(slot + 1, -1);
+        this->next.resize(slot + 1, -1);
+        this->lists.resize(slot + 1, -1);
+    }
+
+    this->prev[slot] = this->tails[list];
+    this->next[slot] = -1;
+    this->lists[slot] = list;
+
+    if (this->tails[list] >= 0) {
+        this->next[this->tails[list]] = slot;
+    }
+    else {
+        this->heads[list] = slot;
+    }
+
+    this->tails[list] = slot;
+}
+
+
+void SlotQueue::remove(const int& slot) {
+    int list = this->lists[slot];
+    int before = this->prev[slot];
+    int behind = this->next[slot];
+
+    if (before >= 0) {
+        this->next[before] = behind;
+    }
+    else {
+        this->heads[list] = behind;
+    }
+
+    if (behind >= 0) {
+        this->prev[behind] = before;
+    }
+    else {
+        this->tails[list] = before;
+    }
+
+    this->prev[slot] = -1;
+    this->next[slot] = -1;
+    this->lists[slot] = -1;
+}
+
+
+// ----- GETTERS
+
+
+bool SlotQueue::contains(const int& slot) const {
+    return slot < (int) this->lists.size() && this->lists[slot] >= 0;
+}
+
+const int& SlotQueue::front(const int& list) const {
+    return this->heads[list];
+}
+
+const int& SlotQueue::after(const int& slot) const {
+    return this->next[slot];
+}
@@ -0,0 +1,46 @@
+#ifndef SLOT_QUEUE_HPP
+#define SLOT_QUEUE_HPP
+
+#include <vector>
+
+
+/******************************************************************************
+ *
+ * 	FIFOs of slots of clients in order they got to some state (waiting
+ * 	for opponent, disconnected), one FIFO per list (one list, or one per
+ * 	rating bucket). Links are kept by slot, so client is pushed, removed
+ * 	from any place and popped in O(1) without allocating anything, once
+ * 	links for the slot exist.
+ *
+ */
+class SlotQueue {
+private:
+    /** Previous slot in list by slot (-1 == none). */
+    std::vector<int> prev;
+    /** Next slot in list by slot (-1 == none). */
+    std::vector<int> next;
+    /** List of slot, which is in queue. */
+    std::vector<int> lists;
+    /** First slot in every list (-1 == empty). */
+    std::vector<int> heads;
+    /** Last slot in every list (-1 == empty). */
+    std::vector<int> tails;
+
+public:
+    explicit SlotQueue(const int& = 1);
+
+    /** Append slot, which is not in queue, to the end of given list. */
+    void push(const int&, const int&);
+    /** Remove slot, which is in queue. */
+    void remove(const int&);
+
+    /** Slot is in some list. */
+    [[nodiscard]] bool contains(const int&) const;
+    /** First slot in given list, -1 when empty. */
+    [[nodiscard]] const int& front(const int&) const;
+    /** Slot after given one in its list, -1 when it is last. */
+    [[nodiscard]] const int& after(const int&) const;
+};
+
+
+#endif
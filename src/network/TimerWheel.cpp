@@ -0,0 +1,116 @@
+// timerfd_create()
+#include <sys/timerfd.h>
+// close(), read()
+#include <unistd.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "TimerWheel.hpp"
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+/******************************************************************************
+ *
+ * 	Timerfd ticks periodically, no matter whether there are some timers,
+ * 	so the wheel stays in step with time without arming it again.
+ *
+ */
+TimerWheel::TimerWheel(const int& tick) {
+    struct itimerspec period{};
+
+    this->tickMsec = tick;
+    this->slots = std::vector<std::vector<Timer>>(SLOTS);
+    this->current = 0;
+
+    this->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (this->timerFd < 0) {
+        throw std::runtime_error(std::string("Unable to create timerfd for timer wheel."));
+    }
+
+    period.it_interval.tv_sec = tick / 1000;
+    period.it_interval.tv_nsec = (tick % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+
+    if (timerfd_settime(this->timerFd, 0, &period, nullptr) != 0) {
+        close(this->timerFd);
+        throw std::runtime_error(std::string("Unable to start timerfd for timer wheel."));
+    }
+}
+
+
+TimerWheel::~TimerWheel() {
+    close(this->timerFd);
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+void TimerWheel::schedule(const int& key, const int& msec) {
+    // round up, timer never expires sooner than asked
+    int ticks = (msec + this->tickMsec - 1) / this->tickMsec;
+
+    if (ticks < 1) {
+        ticks = 1;
+    }
+
+    this->slots[(this->current + ticks) & MASK].push_back({key, (ticks - 1) / SLOTS});
+}
+
+
+/******************************************************************************
+ *
+ * 	Timerfd tells, how many ticks elapsed since it was read last time
+ * 	(more than one, when the loop was busy), so the wheel catches up.
+ *
+ */
+void TimerWheel::expire(std::vector<int>& keys) {
+    uint64_t ticks = 0;
+
+    keys.clear();
+
+    // non-blocking, fails when no tick elapsed yet
+    if (read(this->timerFd, &ticks, sizeof(ticks)) != sizeof(ticks)) {
+        return;
+    }
+
+    for (; ticks > 0; --ticks) {
+        std::vector<Timer>& slot = this->slots[++this->current & MASK];
+        int kept = 0;
+
+        // expired timers out, the rest waits for next round
+        for (auto& timer : slot) {
+            if (timer.rounds == 0) {
+                keys.push_back(timer.key);
+            }
+            else {
+                timer.rounds -= 1;
+                slot[kept++] = timer;
+            }
+        }
+
+        slot.resize(kept);
+    }
+}
+
+
+// ----- GETTERS
+
+
+const int& TimerWheel::getFd() const {
+    return this->timerFd;
+}
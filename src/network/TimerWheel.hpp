@@ -0,0 +1,55 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <vector>
+
+
+/******************************************************************************
+ *
+ * 	Hashed timer wheel driven by timerfd, which is watched by the reactor.
+ * 	Every tick moves the wheel by one slot and only timers in that slot
+ * 	are looked at, so expiring costs as much as there are expiring timers.
+ * 	Timers are not cancelled -- owner of expired key finds out, whether
+ * 	the key is still valid.
+ *
+ */
+class TimerWheel {
+private:
+    /** Count of slots (power of 2). Longer deadlines wait for more rounds. */
+    constexpr static const int SLOTS = 128;
+    /** Mask for indexing slots with ticks. */
+    constexpr static const unsigned MASK = SLOTS - 1;
+
+    /** One scheduled timer. */
+    struct Timer {
+        /** Key given by owner. */
+        int key;
+        /** Count of full turns of wheel before expiry. */
+        int rounds;
+    };
+
+    /** Length of one tick in milliseconds. */
+    int tickMsec;
+    /** Timers hashed by tick of their expiry. */
+    std::vector<std::vector<Timer>> slots;
+    /** Count of ticks since start. */
+    unsigned current;
+
+    /** Timerfd, which ticks periodically. */
+    int timerFd;
+
+public:
+    explicit TimerWheel(const int&);
+    ~TimerWheel();
+
+    /** Schedule timer with given key after given milliseconds (at least one tick). */
+    void schedule(const int&, const int&);
+    /** Move wheel by ticks elapsed since last call and put keys of expired timers to given vector. */
+    void expire(std::vector<int>&);
+
+    // getters
+    [[nodiscard]] const int& getFd() const;
+};
+
+
+#endif
@@ -0,0 +1,889 @@
+// POLLIN
+#include <poll.h>
+// mmap()
+#include <sys/mman.h>
+// send flags
+#include <sys/socket.h>
+// syscall()
+#include <sys/syscall.h>
+// close()
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "../system/Logger.hpp"
+#include "UringReactor.hpp"
+
+
+/** Mask of generation of socket stored in user data of receive request. */
+static const unsigned GENERATION_MASK = 0x1FFFFFFF;
+
+
+// ---------- CONSTRUCTORS & DESTRUCTORS
+
+
+
+
+
+/******************************************************************************
+ *
+ * 	Creates the ring, maps its queues to memory and provides buffers for receiving.
+ * 	Throws an exception, if kernel does not support io_uring or some of needed features.
+ *
+ */
+UringReactor::UringReactor() {
+    struct io_uring_params params{};
+
+    this->sqPtr = MAP_FAILED;
+    this->sqes = (struct io_uring_sqe*) MAP_FAILED;
+    this->toSubmit = 0;
+    this->listenerFd = -1;
+    this->multishotAccept = true;
+    this->acceptAt = -1;
+    this->connections = std::vector<Connection>();
+    this->chains = std::unordered_set<SendChain*>();
+    this->sendersDirty = std::vector<int>();
+    this->starving = std::vector<int>();
+    this->buffersUsed = std::vector<int>();
+    this->closing = std::deque<Closing>();
+
+    // --- INIT RING ---
+
+    this->ringFd = syscall(__NR_io_uring_setup, SIZE_RING, &params);
+
+    if (this->ringFd < 0) {
+        throw std::runtime_error(std::string("Kernel does not support io_uring [") + std::strerror(errno) + "].");
+    }
+
+    // single mapping of both queues (5.4), no dropped completions (5.5), timeout in enter (5.11)
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        close(this->ringFd);
+        throw std::runtime_error(std::string("Kernel io_uring is too old."));
+    }
+
+    // --- INIT QUEUES ---
+
+    this->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    this->cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    this->sqSize = std::max(this->sqSize, this->cqSize);
+    this->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    this->sqPtr = mmap(nullptr, this->sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_SQ_RING);
+    this->sqes = (struct io_uring_sqe*) mmap(nullptr, this->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_SQES);
+
+    if (this->sqPtr == MAP_FAILED || this->sqes == MAP_FAILED) {
+        this->release();
+        throw std::runtime_error(std::string("Unable to map io_uring queues."));
+    }
+
+    this->cqPtr = this->sqPtr;
+
+    this->sqHead  = (unsigned*) ((char*) this->sqPtr + params.sq_off.head);
+    this->sqTail  = (unsigned*) ((char*) this->sqPtr + params.sq_off.tail);
+    this->sqMask  = (unsigned*) ((char*) this->sqPtr + params.sq_off.ring_mask);
+    this->sqArray = (unsigned*) ((char*) this->sqPtr + params.sq_off.array);
+
+    this->cqHead = (unsigned*) ((char*) this->cqPtr + params.cq_off.head);
+    this->cqTail = (unsigned*) ((char*) this->cqPtr + params.cq_off.tail);
+    this->cqMask = (unsigned*) ((char*) this->cqPtr + params.cq_off.ring_mask);
+    this->cqes   = (struct io_uring_cqe*) ((char*) this->cqPtr + params.cq_off.cqes);
+
+    // --- INIT OPERATIONS ---
+
+    try {
+        this->probe();
+    }
+    catch (const std::exception& ex) {
+        this->release();
+        throw;
+    }
+
+    // --- INIT BUFFERS ---
+
+    this->buffers = std::vector<char>(COUNT_BUFFERS * SIZE_BUFF);
+
+    // provide all buffers at once
+    struct io_uring_sqe* sqe = this->getSqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = COUNT_BUFFERS;
+    sqe->addr = (unsigned long long) this->buffers.data();
+    sqe->len = SIZE_BUFF;
+    sqe->off = 0;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = U_Provide;
+
+    this->enter(0, -1);
+}
+
+
+UringReactor::~UringReactor() {
+    this->release();
+
+    // requests were cancelled by closing the ring, so their chains never complete
+    for (auto* chain : this->chains) {
+        if (chain->orphan) {
+            close(chain->fd);
+        }
+        else if (chain->lastFd >= 0) {
+            close(chain->lastFd);
+        }
+
+        delete chain;
+    }
+}
+
+
+
+
+
+// ---------- PRIVATE METHODS
+
+
+
+
+
+void UringReactor::release() {
+    if (this->sqes != MAP_FAILED) {
+        munmap(this->sqes, this->sqesSize);
+    }
+    if (this->sqPtr != MAP_FAILED) {
+        munmap(this->sqPtr, this->sqSize);
+    }
+
+    // closing the ring cancels every request in flight
+    close(this->ringFd);
+}
+
+
+void UringReactor::probe() {
+    const int ops[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_PROVIDE_BUFFERS, IORING_OP_ASYNC_CANCEL, IORING_OP_POLL_ADD};
+    const int count_ops = 256;
+
+    std::vector<char> mem(sizeof(struct io_uring_probe) + count_ops * sizeof(struct io_uring_probe_op), 0);
+    auto* prb = (struct io_uring_probe*) mem.data();
+
+    if (syscall(__NR_io_uring_register, this->ringFd, IORING_REGISTER_PROBE, prb, count_ops) < 0) {
+        throw std::runtime_error(std::string("Unable to probe io_uring operations."));
+    }
+
+    for (const auto& op : ops) {
+        if (op > prb->last_op || !(prb->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            throw std::runtime_error(std::string("Kernel io_uring does not support needed operations."));
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	There is no kernel polling thread, so entry may be published right away,
+ * 	kernel reads it only during io_uring_enter().
+ *
+ */
+struct io_uring_sqe* UringReactor::getSqe() {
+    unsigned tail = *this->sqTail;
+    unsigned head = __atomic_load_n(this->sqHead, __ATOMIC_ACQUIRE);
+
+    // queue is full, submit what is prepared
+    if (tail - head >= SIZE_RING) {
+        this->enter(0, -1);
+    }
+
+    unsigned index = tail & *this->sqMask;
+    struct io_uring_sqe* sqe = &this->sqes[index];
+
+    std::memset(sqe, 0, sizeof(struct io_uring_sqe));
+    this->sqArray[index] = index;
+
+    __atomic_store_n(this->sqTail, tail + 1, __ATOMIC_RELEASE);
+    this->toSubmit += 1;
+
+    return sqe;
+}
+
+
+/******************************************************************************
+ *
+ * 	Submit prepared entries and wait for at least given count of completions,
+ * 	but not longer than given milliseconds (-1 == no limit).
+ * 	Timeout and interruption by signal are not errors.
+ *
+ */
+int UringReactor::enter(const unsigned& minComplete, const int& timeoutMs) {
+    unsigned flags = 0;
+    struct __kernel_timespec ts{};
+    struct io_uring_getevents_arg arg{};
+    void* p_arg = nullptr;
+    size_t arg_size = 0;
+
+    if (minComplete > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+
+        if (timeoutMs >= 0) {
+            ts.tv_sec = timeoutMs / 1000;
+            ts.tv_nsec = (long long) (timeoutMs % 1000) * 1000000;
+            arg.ts = (unsigned long long) &ts;
+
+            flags |= IORING_ENTER_EXT_ARG;
+            p_arg = &arg;
+            arg_size = sizeof(arg);
+        }
+    }
+
+    int rv = syscall(__NR_io_uring_enter, this->ringFd, this->toSubmit, minComplete, flags, p_arg, arg_size);
+
+    if (rv >= 0) {
+        this->toSubmit -= std::min((unsigned) rv, this->toSubmit);
+    }
+    else if (errno == ETIME || errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        rv = 0;
+    }
+
+    return rv;
+}
+
+
+void UringReactor::prepAccept() {
+    struct io_uring_sqe* sqe = this->getSqe();
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = this->listenerFd;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = U_Accept;
+
+    if (this->multishotAccept) {
+        sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+    }
+}
+
+
+void UringReactor::prepPoll(const int& fd) {
+    struct io_uring_sqe* sqe = this->getSqe();
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = ((unsigned long long) fd << 32) | U_Poll;
+}
+
+
+void UringReactor::prepRecv(const int& fd) {
+    struct io_uring_sqe* sqe = this->getSqe();
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->len = SIZE_BUFF;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = ((unsigned long long) fd << 32)
+                   | ((this->connections[fd].generation & GENERATION_MASK) << 3)
+                   | U_Recv;
+}
+
+
+void UringReactor::prepProvide(const int& bid) {
+    struct io_uring_sqe* sqe = this->getSqe();
+
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;
+    sqe->addr = (unsigned long long) &this->buffers[bid * SIZE_BUFF];
+    sqe->len = SIZE_BUFF;
+    sqe->off = bid;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = U_Provide;
+}
+
+
+void UringReactor::prepCancel(const unsigned long long& target) {
+    struct io_uring_sqe* sqe = this->getSqe();
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = target;
+    sqe->user_data = U_Cancel;
+}
+
+
+/******************************************************************************
+ *
+ * 	Submit queued messages of socket as one chain of linked sends, so they
+ * 	are sent in order. Next chain is prepared only after this one completes.
+ * 	MSG_WAITALL makes short send fail the chain, so the rest is not sent out of order.
+ *
+ */
+void UringReactor::prepSends(const int& fd) {
+    Connection& conn = this->connections[fd];
+
+    if (conn.chain != nullptr || conn.queue.empty()) {
+        return;
+    }
+
+    auto* chain = new SendChain{fd, conn.generation, std::deque<std::string>(), 0, 0, false, false, -1, ""};
+
+    while (!conn.queue.empty() && (int) chain->msgs.size() < LONGEST_CHAIN) {
+        chain->msgs.push_back(std::move(conn.queue.front()));
+        conn.queue.pop_front();
+    }
+
+    this->prepChain(chain);
+
+    conn.chain = chain;
+}
+
+
+void UringReactor::prepChain(SendChain* chain) {
+    this->chains.insert(chain);
+
+    // whole chain has to be submitted at once
+    unsigned head = __atomic_load_n(this->sqHead, __ATOMIC_ACQUIRE);
+    if (*this->sqTail - head + chain->msgs.size() > SIZE_RING) {
+        this->enter(0, -1);
+    }
+
+    for (std::size_t i = 0; i < chain->msgs.size(); ++i) {
+        struct io_uring_sqe* sqe = this->getSqe();
+
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = chain->fd;
+        sqe->addr = (unsigned long long) chain->msgs[i].data();
+        sqe->len = chain->msgs[i].size();
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe->user_data = (unsigned long long) chain | U_Send;
+
+        // link every send with the next one
+        if (i + 1 < chain->msgs.size()) {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+
+        chain->pending += 1;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Chain of removed socket completed (or was cancelled), so what it did
+ * 	not send and last output of the socket are sent to the socket kept
+ * 	open by reactor (or its duplicate), which is closed after that.
+ * 	Nothing is sent, when connection is broken.
+ *
+ */
+void UringReactor::prepLast(SendChain* chain) {
+    std::string rest;
+
+    if (!chain->msgs.empty()) {
+        chain->msgs.front().erase(0, chain->sentFront);
+    }
+
+    for (const auto& msg : chain->msgs) {
+        rest += msg;
+    }
+
+    if (!chain->msgs.empty() || !chain->broken) {
+        rest += chain->last;
+    }
+
+    if (rest.empty()) {
+        this->closeFd(chain->lastFd);
+        return;
+    }
+
+    auto* orphan = new SendChain{chain->lastFd, 0, std::deque<std::string>(), 0, 0, false, true, -1, ""};
+    orphan->msgs.push_back(std::move(rest));
+
+    this->prepChain(orphan);
+}
+
+
+void UringReactor::reap(std::vector<ReactorEvent>& events) {
+    unsigned head = *this->cqHead;
+    unsigned tail = __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        this->complete(this->cqes[head & *this->cqMask], events);
+        ++head;
+    }
+
+    __atomic_store_n(this->cqHead, head, __ATOMIC_RELEASE);
+}
+
+
+/******************************************************************************
+ *
+ * 	Handle one completion. Data of receive completions are given to Server
+ * 	as events and buffers are given back to kernel on next wait.
+ *
+ */
+void UringReactor::complete(const struct io_uring_cqe& cqe, std::vector<ReactorEvent>& events) {
+    int op = cqe.user_data & 7;
+
+    if (op == U_Accept) {
+        if (cqe.res >= 0) {
+            events.push_back({cqe.res, R_Accept, nullptr, 0});
+        }
+        else if (cqe.res == -EINVAL && this->multishotAccept) {
+            logger->warning("Kernel does not support multishot accept, accepting one by one.");
+            this->multishotAccept = false;
+        }
+        else if (cqe.res != -ECANCELED) {
+            logger->error("New connection could not be established [%s].", std::strerror(-cqe.res));
+        }
+
+        // without descriptors or memory accept would fail right away again, so it waits a while
+        if (cqe.res == -EMFILE || cqe.res == -ENFILE || cqe.res == -ENOBUFS || cqe.res == -ENOMEM) {
+            this->acceptAt = now() + ACCEPT_RETRY_MS;
+        }
+        // accept has to be prepared again, if it ended
+        else if (!(cqe.flags & IORING_CQE_F_MORE) && this->listenerFd >= 0) {
+            this->prepAccept();
+        }
+    }
+    else if (op == U_Recv) {
+        int fd = cqe.user_data >> 32;
+        unsigned generation = (cqe.user_data >> 3) & GENERATION_MASK;
+        int bid = -1;
+
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+            // give buffer back after Server processes it
+            this->buffersUsed.push_back(bid);
+        }
+
+        // socket was already removed
+        if (fd >= (int) this->connections.size() || (this->connections[fd].generation & GENERATION_MASK) != generation) {
+            return;
+        }
+
+        if (cqe.res > 0 && bid >= 0) {
+            events.push_back({fd, R_Data, &this->buffers[bid * SIZE_BUFF], cqe.res});
+            this->prepRecv(fd);
+        }
+        // end of connection
+        else if (cqe.res == 0) {
+            events.push_back({fd, R_Data, nullptr, 0});
+        }
+        // no free buffer, receive again after some are given back
+        else if (cqe.res == -ENOBUFS) {
+            this->connections[fd].starved = true;
+            this->starving.push_back(fd);
+        }
+        else if (cqe.res != -ECANCELED) {
+            events.push_back({fd, R_Except, nullptr, 0});
+        }
+    }
+    else if (op == U_Poll) {
+        int fd = cqe.user_data >> 32;
+
+        // Server clears the descriptor, so poll may be prepared again right away
+        if (cqe.res > 0) {
+            events.push_back({fd, R_Read, nullptr, 0});
+            this->prepPoll(fd);
+        }
+        // descriptor is broken, polling it again would fail again
+        else if (cqe.res != -ECANCELED) {
+            logger->error("Polling of descriptor [%d] failed [%s].", fd, std::strerror(-cqe.res));
+        }
+    }
+    else if (op == U_Send) {
+        this->completeSend((SendChain*) (cqe.user_data & ~7ULL), cqe.res, events);
+    }
+    else if (op == U_Provide && cqe.res < 0) {
+        logger->error("Buffers could not be provided to kernel [%s].", std::strerror(-cqe.res));
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Completions of linked sends come in order. After last one, whatever
+ * 	was not sent is returned in front of queue of the socket. When everything
+ * 	was sent, socket is reported as writable, so Server flushes more output.
+ *
+ */
+void UringReactor::completeSend(SendChain* chain, const int& res, std::vector<ReactorEvent>& events) {
+    chain->pending -= 1;
+
+    if (!chain->broken) {
+        // whole message sent
+        if (res >= 0 && res == (int) chain->msgs.front().size() - chain->sentFront) {
+            chain->msgs.pop_front();
+            chain->sentFront = 0;
+        }
+        // part of message sent, the rest of chain is cancelled
+        else if (res >= 0) {
+            chain->sentFront += res;
+            chain->broken = true;
+        }
+        // connection is broken, nothing else will be sent
+        else {
+            chain->msgs.clear();
+            chain->broken = true;
+        }
+    }
+
+    if (chain->pending > 0) {
+        return;
+    }
+
+    // closed socket is not needed anymore
+    if (chain->orphan) {
+        this->closeFd(chain->fd);
+    }
+    // socket was removed, but has some last output
+    else if (chain->lastFd >= 0) {
+        this->prepLast(chain);
+    }
+    // socket was not removed in the meantime
+    else if (chain->fd < (int) this->connections.size() && this->connections[chain->fd].generation == chain->generation) {
+        Connection& conn = this->connections[chain->fd];
+        conn.chain = nullptr;
+
+        if (!chain->msgs.empty()) {
+            chain->msgs.front().erase(0, chain->sentFront);
+            conn.queue.insert(conn.queue.begin(), chain->msgs.begin(), chain->msgs.end());
+        }
+
+        if (!conn.queue.empty()) {
+            this->sendersDirty.push_back(chain->fd);
+        }
+        else {
+            events.push_back({chain->fd, R_Write, nullptr, 0});
+        }
+    }
+
+    this->chains.erase(chain);
+    delete chain;
+}
+
+
+UringReactor::Connection& UringReactor::getConnection(const int& fd) {
+    if (fd >= (int) this->connections.size()) {
+        this->connections.resize(fd + 1, Connection{0, std::deque<std::string>(), nullptr, false, -1});
+    }
+
+    return this->connections[fd];
+}
+
+
+long long UringReactor::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/******************************************************************************
+ *
+ * 	Socket, which was not closed within its grace period, is shut down.
+ * 	Its sends fail then and completeSend() closes it. Socket shared with
+ * 	other shard must stay connected, so only its sends are cancelled.
+ * 	Socket closed meanwhile (and maybe reused) has other time of closing,
+ * 	or none.
+ *
+ */
+void UringReactor::stopClosing(const long long& current) {
+    while (!this->closing.empty() && this->closing.front().deadline <= current) {
+        Closing next = this->closing.front();
+        this->closing.pop_front();
+
+        if (this->connections[next.fd].closeBy != next.deadline) {
+            continue;
+        }
+
+        logger->warning("Output of closed socket [%d] was not sent in time, output is dropped.", next.fd);
+
+        if (next.shared) {
+            // one request of chain is issued at a time, cancelling it fails the rest
+            for (const auto& chain : this->chains) {
+                if (chain->lastFd == next.fd || (chain->orphan && chain->fd == next.fd)) {
+                    this->prepCancel((unsigned long long) chain | U_Send);
+                }
+            }
+        }
+        else {
+            shutdown(next.fd, SHUT_RDWR);
+        }
+
+        this->connections[next.fd].closeBy = -1;
+    }
+}
+
+
+void UringReactor::closeFd(const int& fd) {
+    if (fd < (int) this->connections.size()) {
+        this->connections[fd].closeBy = -1;
+    }
+
+    close(fd);
+}
+
+
+std::string UringReactor::takeQueue(Connection& conn) {
+    std::string rest;
+
+    for (const auto& msg : conn.queue) {
+        rest += msg;
+    }
+    conn.queue.clear();
+
+    return rest;
+}
+
+
+/******************************************************************************
+ *
+ * 	Forget socket, which is being removed. Completions of its requests
+ * 	are ignored from now.
+ *
+ */
+void UringReactor::detach(const int& fd) {
+    Connection& conn = this->connections[fd];
+
+    // cancel receive of this generation, completions of older requests will be ignored
+    this->prepCancel(((unsigned long long) fd << 32) | ((conn.generation & GENERATION_MASK) << 3) | U_Recv);
+
+    conn.generation += 1;
+    conn.queue.clear();
+    conn.chain = nullptr;
+    conn.starved = false;
+}
+
+
+
+
+
+// ---------- PUBLIC METHODS
+
+
+
+
+
+bool UringReactor::add(const int& fd, Watch watch) {
+    if (watch == W_Listener) {
+        this->listenerFd = fd;
+        this->prepAccept();
+    }
+    else if (watch == W_Notify) {
+        this->prepPoll(fd);
+    }
+    else {
+        Connection& conn = this->getConnection(fd);
+        conn.chain = nullptr;
+        conn.starved = false;
+        conn.closeBy = -1;
+        conn.queue.clear();
+
+        this->prepRecv(fd);
+    }
+
+    return true;
+}
+
+
+/******************************************************************************
+ *
+ * 	Stop watching socket. Messages, which were not sent yet, are sent as one
+ * 	request and submitted now, so it takes the socket right away. Linked
+ * 	sends of chain look the descriptor up only when they run, so socket
+ * 	with chain in flight is handed over or closed by handOver() and
+ * 	closeSocket(), which keep it open for the chain.
+ *
+ */
+void UringReactor::remove(const int& fd) {
+    if (fd == this->listenerFd) {
+        this->listenerFd = -1;
+        this->acceptAt = -1;
+        this->prepCancel(U_Accept);
+        this->enter(0, -1);
+        return;
+    }
+
+    Connection& conn = this->getConnection(fd);
+    std::string rest = this->takeQueue(conn);
+
+    if (conn.chain == nullptr && !rest.empty()) {
+        conn.queue.push_back(std::move(rest));
+        this->prepSends(fd);
+    }
+
+    this->detach(fd);
+    this->enter(0, -1);
+}
+
+
+/******************************************************************************
+ *
+ * 	Stop watching socket and close it. While output of socket is in flight,
+ * 	the reactor keeps the socket open (so its descriptor is not reused),
+ * 	the rest of output is sent after the chain and socket is closed after
+ * 	that in completeSend(). Peer, which does not read, would keep it open
+ * 	forever, so the output is stopped after CLOSE_GRACE_MS (see
+ * 	stopClosing()). Server does not wait for any of it.
+ *
+ */
+void UringReactor::closeSocket(const int& fd) {
+    this->release(fd, false);
+}
+
+
+void UringReactor::release(const int& fd, const bool& shared) {
+    Connection& conn = this->getConnection(fd);
+    std::string rest = this->takeQueue(conn);
+
+    if (conn.chain == nullptr && !rest.empty()) {
+        conn.queue.push_back(std::move(rest));
+        this->prepSends(fd);
+    }
+    else if (conn.chain != nullptr) {
+        conn.chain->last = std::move(rest);
+    }
+
+    SendChain* chain = conn.chain;
+
+    this->detach(fd);
+    this->enter(0, -1);
+
+    if (chain == nullptr) {
+        close(fd);
+        return;
+    }
+
+    chain->lastFd = fd;
+    conn.closeBy = now() + CLOSE_GRACE_MS;
+    this->closing.push_back({fd, conn.closeBy, shared});
+}
+
+
+/******************************************************************************
+ *
+ * 	Socket without chain in flight goes to other shard as it is. Otherwise
+ * 	the other shard gets its duplicate and the socket itself is closed by
+ * 	the reactor after the chain, so sends of the chain never run on
+ * 	descriptor, which the other shard closed and someone else got.
+ * 	Chain, which is not done in CLOSE_GRACE_MS, is cancelled.
+ *
+ */
+int UringReactor::handOver(const int& fd) {
+    Connection& conn = this->getConnection(fd);
+    int moved = -1;
+
+    if (conn.chain == nullptr) {
+        this->remove(fd);
+        return fd;
+    }
+
+    moved = dup(fd);
+
+    if (moved < 0) {
+        logger->error("Socket [%d] could not be duplicated for other shard [%s].", fd, std::strerror(errno));
+        return -1;
+    }
+
+    this->release(fd, true);
+
+    return moved;
+}
+
+
+int UringReactor::wait(std::vector<ReactorEvent>& events, const int& timeoutMs) {
+    events.clear();
+
+    // buffers from last wait were processed by Server
+    for (const auto& bid : this->buffersUsed) {
+        this->prepProvide(bid);
+    }
+    this->buffersUsed.clear();
+
+    // receive again on sockets, which were without buffers (and were not removed since)
+    for (const auto& fd : this->starving) {
+        if (this->connections[fd].starved) {
+            this->connections[fd].starved = false;
+            this->prepRecv(fd);
+        }
+    }
+    this->starving.clear();
+
+    // send messages queued since last wait
+    for (const auto& fd : this->sendersDirty) {
+        this->prepSends(fd);
+    }
+    this->sendersDirty.clear();
+
+    long long current = now();
+    int timeout = timeoutMs;
+
+    this->stopClosing(current);
+
+    // wake up for the next closed socket, whose output has to be stopped
+    if (!this->closing.empty()) {
+        int left = (int) (this->closing.front().deadline - current);
+        timeout = timeout < 0 ? left : std::min(timeout, left);
+    }
+
+    if (this->acceptAt >= 0 && this->acceptAt <= current) {
+        this->acceptAt = -1;
+        this->prepAccept();
+    }
+    // wake up for delayed accept
+    else if (this->acceptAt >= 0) {
+        int left = (int) (this->acceptAt - current);
+        timeout = timeout < 0 ? left : std::min(timeout, left);
+    }
+
+    if (this->enter(1, timeout) < 0) {
+        return -1;
+    }
+
+    this->reap(events);
+
+    return events.size();
+}
+
+
+/******************************************************************************
+ *
+ * 	Take output of socket, it is sent as linked requests on next wait, so all
+ * 	output of one update costs single io_uring_enter(). While previous chain
+ * 	is in flight, output stays with client, until socket is reported writable.
+ *
+ */
+int UringReactor::flush(const int& fd, OutBuffer& out) {
+    Connection& conn = this->getConnection(fd);
+    bool idle = conn.queue.empty();
+    int taken = 0;
+
+    if (conn.chain != nullptr) {
+        return 0;
+    }
+
+    taken = out.takeAll(conn.queue);
+
+    if (idle && taken > 0) {
+        this->sendersDirty.push_back(fd);
+    }
+
+    return taken;
+}
+
+
+/******************************************************************************
+ *
+ * 	Socket is going to be closed, so its output is taken even while chain
+ * 	is in flight -- closeSocket() sends it after the chain.
+ *
+ */
+int UringReactor::flushLast(const int& fd, OutBuffer& out) {
+    Connection& conn = this->getConnection(fd);
+
+    if (conn.chain == nullptr) {
+        return this->flush(fd, out);
+    }
+
+    return out.takeAll(conn.queue);
+}
+
+
+const char* UringReactor::getName() const {
+    return BACKEND_URING;
+}
@@ -0,0 +1,194 @@
+#ifndef URING_REACTOR_HPP
+#define URING_REACTOR_HPP
+
+#include <linux/io_uring.h>
+
+#include <deque>
+#include <string>
+#include <unordered_set>
+
+#include "Reactor.hpp"
+
+
+/******************************************************************************
+ *
+ * 	io_uring loop. Kernel accepts connections (multishot accept), receives
+ * 	into buffers provided by the reactor and sends messages of one client
+ * 	as linked requests, so Server does no ioctl(), recv() or send() itself.
+ * 	Constructor throws an exception, if kernel does not support what is needed.
+ *
+ */
+class UringReactor : public Reactor {
+private:
+    /** Count of submission queue entries. */
+    constexpr static const unsigned SIZE_RING = 256;
+    /** Count of buffers provided to kernel for receiving. */
+    constexpr static const int COUNT_BUFFERS = 256;
+    /** Size of one provided buffer. */
+    constexpr static const int SIZE_BUFF = 1024;
+    /** Id of group of provided buffers. */
+    constexpr static const int BUFFER_GROUP = 1;
+    /** Longest chain of linked sends submitted at once. */
+    constexpr static const int LONGEST_CHAIN = 16;
+    /** Longest time, which closed socket is kept open for its output in flight. */
+    constexpr static const int CLOSE_GRACE_MS = 1000;
+    /** Delay of next accept, when there were no resources for new socket. */
+    constexpr static const int ACCEPT_RETRY_MS = 100;
+
+    /** Type of request, stored in lowest 3 bits of user data. */
+    enum Op {
+        U_Accept  = 1,
+        U_Recv    = 2,
+        U_Send    = 3,
+        U_Provide = 4,
+        U_Cancel  = 5,
+        U_Poll    = 6
+    };
+
+    /** Messages, which are being sent to one socket as linked requests. */
+    struct SendChain {
+        int fd;
+        unsigned generation;
+        std::deque<std::string> msgs;
+        /** Count of requests of chain, which did not complete yet. */
+        int pending;
+        /** Count of bytes sent from first message in chain. */
+        int sentFront;
+        /** Chain was broken (short send), rest has to be sent again. */
+        bool broken;
+        /** Socket was closed, chain sends its last output and closes it after completion. */
+        bool orphan;
+        /** Closed socket kept open by reactor, which rest of chain and last output are sent to (-1 == none). */
+        int lastFd;
+        /** Last output of removed socket, which waits for chain. */
+        std::string last;
+    };
+
+    /** State of one watched socket indexed by its descriptor. */
+    struct Connection {
+        /** Increased, when socket is removed, so late completions of old requests are ignored. */
+        unsigned generation;
+        /** Messages taken from client's output, which are not in flight yet. */
+        std::deque<std::string> queue;
+        /** Chain of sends in flight (nullptr == none). */
+        SendChain* chain;
+        /** Receive waits for free buffer (socket is in starving). */
+        bool starved;
+        /** Closed socket kept open for its output is stopped at this time (-1 == none). */
+        long long closeBy;
+    };
+
+    /** Closed socket kept open for its output, stopped at given time. */
+    struct Closing {
+        int fd;
+        long long deadline;
+        /** Socket was duplicated for other shard, so only its sends are cancelled. */
+        bool shared;
+    };
+
+    /** Ring descriptor. */
+    int ringFd;
+
+    // submission queue
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    /** Entries prepared, but not submitted yet. */
+    unsigned toSubmit;
+
+    // completion queue
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+
+    // mapped memory of rings
+    void* sqPtr;
+    size_t sqSize;
+    void* cqPtr;
+    size_t cqSize;
+    size_t sqesSize;
+
+    /** Memory of provided buffers. */
+    std::vector<char> buffers;
+    /** Buffers, which Server already processed and may be given back to kernel. */
+    std::vector<int> buffersUsed;
+
+    /** Server socket. */
+    int listenerFd;
+    /** Multishot accept is supported by kernel (since 5.19). */
+    bool multishotAccept;
+    /** Accept is prepared again at this time (-1 == it is not delayed). */
+    long long acceptAt;
+
+    /** Watched sockets. */
+    std::vector<Connection> connections;
+    /** Chains of sends in flight (those, which never complete, are deleted with the ring). */
+    std::unordered_set<SendChain*> chains;
+    /** Sockets with queued messages. */
+    std::vector<int> sendersDirty;
+    /** Sockets with receive waiting for free buffer. */
+    std::vector<int> starving;
+    /** Closed sockets kept open for their output, first closed first. */
+    std::deque<Closing> closing;
+
+    /** Unmap queues and close the ring. */
+    void release();
+
+    /** Check if kernel supports every used operation. */
+    void probe();
+    /** Get free submission queue entry, submit prepared ones if queue is full. */
+    struct io_uring_sqe* getSqe();
+    /** Submit prepared entries and wait for given count of completions. */
+    int enter(const unsigned&, const int&);
+
+    // preparation of requests
+    void prepAccept();
+    void prepPoll(const int&);
+    void prepRecv(const int&);
+    void prepProvide(const int&);
+    void prepCancel(const unsigned long long&);
+    void prepSends(const int&);
+    void prepChain(SendChain*);
+    void prepLast(SendChain*);
+
+    /** Handle all completed requests. */
+    void reap(std::vector<ReactorEvent>&);
+    /** Handle completed request. */
+    void complete(const struct io_uring_cqe&, std::vector<ReactorEvent>&);
+    void completeSend(SendChain*, const int&, std::vector<ReactorEvent>&);
+
+    /** Get state of socket, grow vector of connections if needed. */
+    Connection& getConnection(const int&);
+    /** Take queued messages of socket as one. */
+    static std::string takeQueue(Connection&);
+    /** Stop requests on removed socket. */
+    void detach(const int&);
+    /** Keep socket with chain in flight open, until the chain completes. */
+    void release(const int&, const bool&);
+    /** Stop output of closed sockets, whose grace period is over. */
+    void stopClosing(const long long&);
+    /** Close socket owned by reactor. */
+    void closeFd(const int&);
+    /** Monotonic time in milliseconds. */
+    static long long now();
+
+public:
+    UringReactor();
+    ~UringReactor() override;
+
+    bool add(const int&, Watch) override;
+    void remove(const int&) override;
+    void closeSocket(const int&) override;
+    int handOver(const int&) override;
+    int wait(std::vector<ReactorEvent>&, const int&) override;
+    int flush(const int&, OutBuffer&) override;
+    int flushLast(const int&, OutBuffer&) override;
+
+    [[nodiscard]] const char* getName() const override;
+};
+
+
+#endif
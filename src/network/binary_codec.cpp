@@ -0,0 +1,326 @@
+#include <cstring>
+
+#include "binary_codec.hpp"
+#include "packet_handler.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Binary protocol is only different framing of the text one, so binary
+ * 	messages of client are transcoded to text frames before parsing, and
+ * 	replies are transcoded from text frames just before queuing.
+ * 	All requests are served by the same handlers this way.
+ *
+ */
+
+
+/** How payload of message is transcoded. */
+enum Payload {
+    P_None,
+    P_Text,
+    P_Move,
+    P_Game
+};
+
+/** Binary message by text frame (or by its beginning, when it has payload). */
+struct Reply {
+    std::string text;
+    BinaryOpcode op;
+    Payload payload;
+};
+
+/** Longest varint of payload length (up to 16383 bytes). */
+constexpr static const int VARINT_MAX = 2;
+/** Size of side of playfield, square is packed as y * SIZE + x. */
+constexpr static const int PF_SIZE = 11;
+/** Bits of one square of playfield (fields have values 0..5). */
+constexpr static const int PF_BITS = 3;
+
+static const std::string PREFIX_IN_GAME = Protocol::OP_SOH + Protocol::SC_IN_GAME + Protocol::OP_SEP;
+static const std::string PREFIX_RECN_GAME = Protocol::OP_SOH + Protocol::SC_RESP_RECN + Protocol::OP_SEP
+                                          + Protocol::SC_IN_GAME + Protocol::OP_SEP;
+static const std::string SUFFIX_TURN_YOU = Protocol::SC_TURN_YOU + Protocol::OP_SEP + Protocol::SC_OPN_NAME + Protocol::OP_INI;
+static const std::string SUFFIX_TURN_OPN = Protocol::SC_TURN_OPN + Protocol::OP_SEP + Protocol::SC_OPN_NAME + Protocol::OP_INI;
+static const std::string PREFIX_PLAYFIELD = Protocol::OP_SEP + Protocol::SC_PLAYFIELD + Protocol::OP_INI;
+
+static const Reply REPLIES[] = {
+    {Protocol::FRAME_PING,          B_Ping,             P_None},
+    {Protocol::FRAME_PONG,          B_Pong,             P_None},
+    {Protocol::FRAME_RESP_LEAVE,    B_RespLeave,        P_None},
+    {Protocol::FRAME_RECN_LOBBY,    B_RecnLobby,        P_None},
+    {Protocol::FRAME_IN_LOBBY,      B_InLobby,          P_None},
+    {Protocol::FRAME_MV_VALID,      B_MoveValid,        P_None},
+    {Protocol::FRAME_GO_WIN,        B_GameWin,          P_None},
+    {Protocol::FRAME_GO_LOSS,       B_GameLoss,         P_None},
+    {Protocol::FRAME_OPN_LEAVE,     B_OpnLeave,         P_None},
+    {Protocol::FRAME_OPN_LOST,      B_OpnLost,          P_None},
+    {Protocol::FRAME_OPN_DISC,      B_OpnDisc,          P_None},
+    {Protocol::FRAME_OPN_RECN,      B_OpnRecn,          P_None},
+    {Protocol::FRAME_OPN_GONE,      B_OpnGone,          P_None},
+    {Protocol::FRAME_NICK_USED,     B_NickUsed,         P_None},
+    {Protocol::FRAME_SESS_GONE,     B_SessGone,         P_None},
+    {Protocol::FRAME_KICK,          B_Kick,             P_None},
+    {Protocol::FRAME_SHDW,          B_Shutdown,         P_None},
+    {Protocol::OP_SOH + Protocol::SC_RESP_CONN + Protocol::OP_INI,          B_RespConn,         P_Text},
+    {PREFIX_IN_GAME + SUFFIX_TURN_YOU,                                      B_InGameOnTurn,     P_Text},
+    {PREFIX_IN_GAME + SUFFIX_TURN_OPN,                                      B_InGameOnStand,    P_Text},
+    {PREFIX_RECN_GAME + SUFFIX_TURN_YOU,                                    B_RecnGameOnTurn,   P_Game},
+    {PREFIX_RECN_GAME + SUFFIX_TURN_OPN,                                    B_RecnGameOnStand,  P_Game},
+    {Protocol::OP_SOH + Protocol::SC_OPN_MOVE + Protocol::OP_INI,           B_OpnMove,          P_Move},
+    {Protocol::OP_SOH + Protocol::OP_CHAT + Protocol::OP_INI,               B_Chat,             P_Text},
+};
+
+
+static int writeVarint(int value, char* dst) {
+    int len = 0;
+
+    while (value >= 0x80) {
+        dst[len++] = (char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+
+    dst[len++] = (char) value;
+
+    return len;
+}
+
+
+/******************************************************************************
+ *
+ * 	Move "xxyyxxyy" (from and to) is two squares, one byte each.
+ *
+ */
+static void packMove(const std::string_view& move, char* dst) {
+    for (int i = 0; i < 2; ++i) {
+        int x = (move[i * 4] - '0') * 10 + (move[i * 4 + 1] - '0');
+        int y = (move[i * 4 + 2] - '0') * 10 + (move[i * 4 + 3] - '0');
+
+        dst[i] = (char) (y * PF_SIZE + x);
+    }
+}
+
+
+static bool unpackMove(const std::string_view& packed, std::string& move) {
+    for (int i = 0; i < 2; ++i) {
+        int square = (unsigned char) packed[i];
+
+        if (square >= PF_SIZE * PF_SIZE) {
+            return false;
+        }
+
+        move += (char) ('0' + square % PF_SIZE / 10);
+        move += (char) ('0' + square % PF_SIZE % 10);
+        move += (char) ('0' + square / PF_SIZE / 10);
+        move += (char) ('0' + square / PF_SIZE % 10);
+    }
+
+    return true;
+}
+
+
+/******************************************************************************
+ *
+ * 	Digits of playfield by 3 bits, the lowest bits first.
+ *
+ */
+static int packPlayfield(const std::string_view& pf, char* dst) {
+    int len = ((int) pf.length() * PF_BITS + 7) / 8;
+    int bit = 0;
+
+    std::memset(dst, 0, len);
+
+    for (const char& digit : pf) {
+        int field = digit - '0';
+
+        dst[bit / 8] |= (char) (field << (bit % 8));
+
+        // field crosses border of byte
+        if (bit % 8 > 8 - PF_BITS) {
+            dst[bit / 8 + 1] |= (char) (field >> (8 - bit % 8));
+        }
+
+        bit += PF_BITS;
+    }
+
+    return len;
+}
+
+
+int headerLength(const char* bytes, const int& available, int& payload) {
+    payload = 0;
+
+    for (int i = 1; i <= VARINT_MAX; ++i) {
+        if (i >= available) {
+            return 0;
+        }
+
+        payload |= ((unsigned char) bytes[i] & 0x7f) << (7 * (i - 1));
+
+        if (((unsigned char) bytes[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+
+    return -1;
+}
+
+
+/******************************************************************************
+ *
+ * 	Every payload is checked by the same rules as values of text protocol,
+ * 	so it can't break out of its frame.
+ *
+ */
+int decodeMessages(const std::string_view& msgs, std::string& frames) {
+    std::size_t pos = 0;
+    int header = 0;
+    int payload = 0;
+
+    while (pos < msgs.length()) {
+        header = headerLength(&msgs[pos], msgs.length() - pos, payload);
+
+        if (header <= 0 || pos + header + payload > msgs.length()) {
+            return 1;
+        }
+
+        std::string_view value = msgs.substr(pos + header, payload);
+        const std::string* key = nullptr;
+        Opcode op = O_Unknown;
+
+        switch ((unsigned char) msgs[pos]) {
+            case B_Ping:
+                op = O_Ping;
+                key = &Protocol::OP_PING;
+                break;
+            case B_Pong:
+                op = O_Pong;
+                key = &Protocol::OP_PONG;
+                break;
+            case B_Chat:
+                op = O_Chat;
+                key = &Protocol::OP_CHAT;
+                break;
+            case B_Conn:
+                op = O_Conn;
+                key = &Protocol::CC_CONN;
+                break;
+            case B_Resume:
+                op = O_Resume;
+                key = &Protocol::CC_RESM;
+                break;
+            case B_Ready:
+                op = O_Ready;
+                key = &Protocol::CC_READY;
+                break;
+            case B_Move:
+                op = O_Move;
+                key = &Protocol::CC_MOVE;
+                break;
+            case B_Leave:
+                op = O_Leave;
+                key = &Protocol::CC_LEAV;
+                break;
+            case B_Ok:
+                op = O_Ok;
+                key = &Protocol::CC_OK;
+                break;
+            default:
+                return 1;
+        }
+
+        frames += Protocol::OP_SOH;
+        frames += *key;
+
+        if (op == O_Move) {
+            frames += Protocol::OP_INI;
+
+            if (payload != 2 || !unpackMove(value, frames)) {
+                return 1;
+            }
+        }
+        else if (valueOf(op) != V_None) {
+            if (!isValueLength(valueOf(op), payload)) {
+                return 1;
+            }
+
+            for (const char& c : value) {
+                if (!isValueChar(valueOf(op), c)) {
+                    return 1;
+                }
+            }
+
+            frames += Protocol::OP_INI;
+            frames += value;
+        }
+        else if (payload != 0) {
+            return 1;
+        }
+
+        frames += Protocol::OP_EOT;
+        pos += header + payload;
+    }
+
+    return 0;
+}
+
+
+std::size_t encodeFrame(const std::string_view& frame, char* dst) {
+    for (const auto& reply : REPLIES) {
+        std::string_view value;
+        std::size_t len = 1;
+
+        if (reply.payload == P_None) {
+            if (frame != reply.text) {
+                continue;
+            }
+        }
+        else if (frame.length() <= reply.text.length() || frame.compare(0, reply.text.length(), reply.text) != 0) {
+            continue;
+        }
+        else {
+            // value without closing bracket
+            value = frame.substr(reply.text.length(), frame.length() - reply.text.length() - 1);
+        }
+
+        dst[0] = (char) reply.op;
+
+        switch (reply.payload) {
+            case P_None:
+                len += writeVarint(0, dst + len);
+                break;
+            case P_Text:
+                len += writeVarint(value.length(), dst + len);
+                std::memcpy(dst + len, value.data(), value.length());
+                len += value.length();
+                break;
+            case P_Move:
+                len += writeVarint(2, dst + len);
+                packMove(value, dst + len);
+                len += 2;
+                break;
+            case P_Game: {
+                // nick,pf:playfield
+                std::size_t comma = value.find(PREFIX_PLAYFIELD);
+
+                if (comma == std::string_view::npos) {
+                    return 0;
+                }
+
+                std::string_view nick = value.substr(0, comma);
+                std::string_view pf = value.substr(comma + PREFIX_PLAYFIELD.length());
+                int packed = (pf.length() * PF_BITS + 7) / 8;
+
+                len += writeVarint(1 + nick.length() + packed, dst + len);
+                dst[len++] = (char) nick.length();
+                std::memcpy(dst + len, nick.data(), nick.length());
+                len += nick.length();
+                len += packPlayfield(pf, dst + len);
+                break;
+            }
+        }
+
+        return len;
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef BINARY_CODEC_HPP
+#define BINARY_CODEC_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+/** Length of header of binary message at the beginning of given bytes, length of its payload is put
+ *  to the last argument. Returns 0, when header is not complete yet, and -1, when it can't be valid. */
+int headerLength(const char*, const int&, int&);
+
+/** Transcode whole binary messages of client to text frames appended to given string.
+ *  Returns 0, if all messages are valid, otherwise 1. */
+int decodeMessages(const std::string_view&, std::string&);
+
+/** Transcode text frame of reply to binary message written to given destination, which
+ *  has to hold at least length of the frame. Returns length of message, 0 for unknown frame. */
+std::size_t encodeFrame(const std::string_view&, char*);
+
+
+#endif
@@ -0,0 +1,145 @@
+#if defined(__x86_64__) || defined(__i386__)
+// SSE2 and AVX2 intrinsics
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+#include "frame_scan.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Received bytes are mostly frames without any newline, so kernels copy
+ * 	whole blocks, which have no byte to skip, and only blocks with some
+ * 	newline are compacted byte by byte. Kernel is picked once by CPU.
+ *
+ */
+
+static bool isSkipped(const char& c) {
+    return c == '\n' || c == '\r' || c == '\0';
+}
+
+
+static std::size_t stripScalar(const char* src, std::size_t len, char* dst) {
+    std::size_t out = 0;
+
+    for (std::size_t i = 0; i < len; ++i) {
+        if (!isSkipped(src[i])) {
+            dst[out++] = src[i];
+        }
+    }
+
+    return out;
+}
+
+
+#ifdef SCAN_X86
+
+__attribute__((target("sse2")))
+static std::size_t stripSse2(const char* src, std::size_t len, char* dst) {
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i nul = _mm_setzero_si128();
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+
+    // out never overtakes i, so block is always loaded before it is overwritten
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i skip = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr)),
+                                    _mm_cmpeq_epi8(block, nul));
+
+        if (_mm_movemask_epi8(skip) == 0) {
+            _mm_storeu_si128((__m128i*) (dst + out), block);
+            out += 16;
+        }
+        else {
+            out += stripScalar(src + i, 16, dst + out);
+        }
+    }
+
+    return out + stripScalar(src + i, len - i, dst + out);
+}
+
+
+__attribute__((target("avx2")))
+static std::size_t stripAvx2(const char* src, std::size_t len, char* dst) {
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i nul = _mm256_setzero_si256();
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i skip = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, lf), _mm256_cmpeq_epi8(block, cr)),
+                                       _mm256_cmpeq_epi8(block, nul));
+
+        if (_mm256_movemask_epi8(skip) == 0) {
+            _mm256_storeu_si256((__m256i*) (dst + out), block);
+            out += 32;
+        }
+        else {
+            out += stripScalar(src + i, 32, dst + out);
+        }
+    }
+
+    // SSE2 kernel is not VEX encoded, so upper halves have to be clean for it (and for caller)
+    _mm256_zeroupper();
+
+    // rest is shorter than one AVX2 block
+    return out + stripSse2(src + i, len - i, dst + out);
+}
+
+#endif
+
+
+static ScanKernel pickKernel(const char** name) {
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return stripAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return stripSse2;
+    }
+#endif
+
+    *name = "scalar";
+    return stripScalar;
+}
+
+
+static const char* kernelName = nullptr;
+static const ScanKernel kernel = pickKernel(&kernelName);
+
+
+std::size_t stripSkipped(const char* src, const std::size_t& len, char* dst) {
+    return kernel(src, len, dst);
+}
+
+
+const char* getScanKernel() {
+    return kernelName;
+}
+
+
+std::vector<std::pair<const char*, ScanKernel>> getScanKernels() {
+    std::vector<std::pair<const char*, ScanKernel>> kernels = {{"scalar", stripScalar}};
+
+#ifdef SCAN_X86
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.emplace_back("sse2", stripSse2);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.emplace_back("avx2", stripAvx2);
+    }
+#endif
+
+    return kernels;
+}
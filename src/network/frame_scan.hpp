@@ -0,0 +1,23 @@
+#ifndef FRAME_SCAN_HPP
+#define FRAME_SCAN_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/** Kernel of stripSkipped(), arguments are source, its length and destination. */
+using ScanKernel = std::size_t (*)(const char*, std::size_t, char*);
+
+/** Copy bytes to destination without newlines and null characters, which are not part of protocol.
+ *  Destination may be the same as source (compacting in place). Returns count of copied bytes. */
+std::size_t stripSkipped(const char*, const std::size_t&, char*);
+
+/** Name of kernel picked for this CPU. */
+const char* getScanKernel();
+
+/** All kernels, which this CPU can run, by name. Scalar one (the reference) is the first. */
+std::vector<std::pair<const char*, ScanKernel>> getScanKernels();
+
+
+#endif
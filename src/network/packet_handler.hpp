@@ -6,31 +6,214 @@
 
 // TODO longterm: better architecture, inline vs. namespace vs. in helper class ?
 
+/** What characters value of request may have. */
+enum Value {
+    V_None,
+    V_Nick,
+    V_Move,
+    V_Token,
+    V_Chat
+};
+
+
 /******************************************************************************
  *
- * 	Check if received message is according to protocol.
+ * 	Intern key of request (keys have one or two characters).
  *
  */
-inline int isValidFormat(const std::string& msg) {
-    // same reason for 1 as false like in Server::serveClient()
-    return std::regex_match(msg, Protocol::rgx_valid_format) ? 0 : 1;
+inline Opcode opcodeOf(const std::string_view& key) {
+    if (key.length() == 1) {
+        switch (key[0]) {
+            case '>':
+                return O_Ping;
+            case '<':
+                return O_Pong;
+            case 'c':
+                return O_Conn;
+            case 'm':
+                return O_Move;
+            case 'l':
+                return O_Leave;
+            default:
+                return O_Unknown;
+        }
+    }
+
+    if (key == Protocol::CC_CONN_BIN) {
+        return O_ConnBin;
+    }
+    if (key == Protocol::CC_RESM) {
+        return O_Resume;
+    }
+    if (key == Protocol::CC_RESM_BIN) {
+        return O_ResumeBin;
+    }
+    if (key == Protocol::CC_READY) {
+        return O_Ready;
+    }
+    if (key == Protocol::OP_CHAT) {
+        return O_Chat;
+    }
+    if (key == Protocol::CC_OK) {
+        return O_Ok;
+    }
+
+    return O_Unknown;
+}
+
+
+/******************************************************************************
+ *
+ * 	Kind of value, which request with given opcode has (V_None also for unknown).
+ *
+ */
+inline Value valueOf(const Opcode& op) {
+    switch (op) {
+        case O_Conn:
+        case O_ConnBin:
+            return V_Nick;
+        case O_Move:
+            return V_Move;
+        case O_Resume:
+        case O_ResumeBin:
+            return V_Token;
+        case O_Chat:
+            return V_Chat;
+        default:
+            return V_None;
+    }
 }
 
 
 /******************************************************************************
  *
- * 	Parse message.
+ * 	Requests, which are valid without value.
  *
  */
-inline void parseMsg(std::string msg, clientData& data) {
-    std::smatch match;
+inline bool isAlone(const Opcode& op) {
+    return op == O_Ping || op == O_Pong || op == O_Ready || op == O_Leave || op == O_Ok;
+}
 
-    // search every brackets with data in message and emplace it to vector
-    while (regex_search(msg, match, Protocol::rgx_data)) {
-        data.emplace(match.str());
-        msg = match.suffix();
+
+/******************************************************************************
+ *
+ * 	Check character of value (ASCII only, same as in regular expressions
+ * 	of protocol, so no diacritics).
+ *
+ */
+inline bool isValueChar(const Value& kind, const char& c) {
+    bool digit = c >= '0' && c <= '9';
+    bool alnum = digit || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+
+    switch (kind) {
+        case V_Nick:
+            return alnum || c == '_';
+        case V_Move:
+            return digit;
+        case V_Token:
+            return digit || (c >= 'a' && c <= 'f');
+        case V_Chat:
+            return alnum || c == ' ' || (c >= '\t' && c <= '\r') || c == '.' || c == '!' || c == '?';
+        default:
+            return false;
     }
 }
 
 
+/******************************************************************************
+ *
+ * 	Check length of value.
+ *
+ */
+inline bool isValueLength(const Value& kind, const int& len) {
+    switch (kind) {
+        case V_Nick:
+            return len >= Protocol::NICK_MIN && len <= Protocol::NICK_MAX;
+        case V_Move:
+            return len == Protocol::MOVE_LEN;
+        case V_Token:
+            return len == Protocol::TOKEN_LEN;
+        case V_Chat:
+            return len >= 1 && len <= Protocol::CHAT_MAX;
+        default:
+            return false;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Check, if received message is according to protocol, and parse it
+ * 	in one pass. Requests view the message, nothing is copied.
+ * 	Returns 0, if message is valid, otherwise 1 and no requests.
+ *
+ */
+inline int parseMsg(const std::string_view& msg, clientData& data) {
+    size_t pos = 0;
+    size_t start = 0;
+    bool valid = !msg.empty();
+    Value kind = V_None;
+    request rqst;
+
+    data.clear();
+
+    while (valid && pos < msg.length()) {
+        // start of header
+        if (msg[pos] != Protocol::OP_SOH[0]) {
+            valid = false;
+            break;
+        }
+
+        // key up to initializer of data, or up to end of transmission
+        start = ++pos;
+
+        while (pos < msg.length() && msg[pos] != Protocol::OP_INI[0] && msg[pos] != Protocol::OP_EOT[0]) {
+            ++pos;
+        }
+
+        if (pos == msg.length()) {
+            valid = false;
+            break;
+        }
+
+        rqst.key = msg.substr(start, pos - start);
+        rqst.op = opcodeOf(rqst.key);
+        rqst.value = std::string_view();
+
+        // value, whose characters are checked according to key
+        if (msg[pos] == Protocol::OP_INI[0]) {
+            kind = valueOf(rqst.op);
+            start = ++pos;
+
+            while (pos < msg.length() && msg[pos] != Protocol::OP_EOT[0] && isValueChar(kind, msg[pos])) {
+                ++pos;
+            }
+
+            if (pos == msg.length() || msg[pos] != Protocol::OP_EOT[0] || !isValueLength(kind, pos - start)) {
+                valid = false;
+                break;
+            }
+
+            rqst.value = msg.substr(start, pos - start);
+        }
+        else if (!isAlone(rqst.op)) {
+            valid = false;
+            break;
+        }
+
+        // end of transmission
+        ++pos;
+
+        data.push_back(rqst);
+    }
+
+    if (!valid) {
+        data.clear();
+    }
+
+    // same reason for 1 as false like in Server::serveClient()
+    return valid ? 0 : 1;
+}
+
+
 #endif
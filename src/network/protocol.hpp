@@ -1,15 +1,35 @@
 #ifndef PROTOCOL_HPP
 #define PROTOCOL_HPP
 
-#include <regex>
-#include <queue>
-
-
-// same things with different name for better clarity in code
-/** Data received from client. */
-using clientData = std::queue<std::string>;
-/** Parsed data received from client */
-using request = std::queue<std::string>;
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/** Key of request interned by parser, so it is routed without comparing strings. */
+enum Opcode {
+    O_Unknown,
+    O_Ping,
+    O_Pong,
+    O_Conn,
+    O_ConnBin,
+    O_Resume,
+    O_ResumeBin,
+    O_Ready,
+    O_Move,
+    O_Leave,
+    O_Chat,
+    O_Ok
+};
+
+/** One request of client -- key and value (empty, if there is none) viewing received message. */
+struct request {
+    Opcode op;
+    std::string_view key;
+    std::string_view value;
+};
+/** Requests parsed from message received from client (valid until the message changes). */
+using clientData = std::vector<request>;
 
 namespace Protocol {
 
@@ -17,9 +37,11 @@ namespace Protocol {
 
     // C -> S
     // {c:nick}
+    // {rs:0123456789abcdef}
     // {m:07050710}
 
     // S -> C
+    // {rc:0123456789abcdef}
     // {rr,il}
     // {rr,ig,ty,op:onick,pf:0..9}
     // -> {rr,ig,ty,op:onick,pf:0000000000111111111122222222223333333333444444444455555555550000000000111111111122222222223333333333}
@@ -38,12 +60,16 @@ namespace Protocol {
 
     // client codes
     static const std::string CC_CONN    ("c");  // connect
+    static const std::string CC_CONN_BIN("cb"); // connect and switch to binary protocol
+    static const std::string CC_RESM    ("rs"); // resume session by token
+    static const std::string CC_RESM_BIN("rb"); // resume session by token and switch to binary protocol
     static const std::string CC_READY   ("rd"); // ready
     static const std::string CC_MOVE    ("m");  // move
     static const std::string CC_LEAV    ("l");  // leave game
+    static const std::string CC_OK      ("ok"); // acknowledge (valid format, but not served)
 
     // server codes
-    static const std::string SC_RESP_CONN    ("rc"); // response connect
+    static const std::string SC_RESP_CONN    ("rc"); // response connect (with session token)
     static const std::string SC_RESP_RECN    ("rr"); // response reconnect
     static const std::string SC_RESP_LEAVE   ("rl"); // response leave
     static const std::string SC_IN_LOBBY     ("il"); // client moved to lobby
@@ -63,22 +89,94 @@ namespace Protocol {
     static const std::string SC_OPN_GONE     ("og"); // opponent is gone -- instance erased
     static const std::string SC_MANY_CLNT    ("t");  // too many clients message
     static const std::string SC_NICK_USED    ("u");  // nick is already used
+    static const std::string SC_SESS_GONE    ("sg"); // session of token is gone -- connect with nick
     static const std::string SC_KICK         ("k");  // kick client
     static const std::string SC_SHDW         ("s");  // server shutdown
 
-    // note: 'a-zA-Z0-9' instead of '\w' to prevent diacritics
-    // server regex -- valid format:            (?:\{(?:<|>|c:\w{3,20}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100})\})+
-    static const std::regex rgx_valid_format(R"((?:\{(?:<|>|c:\w{3,20}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100})\})+)");
+    // whole frames of fixed replies, prepared in advance
+    static const std::string FRAME_PING       = OP_SOH + OP_PING + OP_EOT;
+    static const std::string FRAME_PONG       = OP_SOH + OP_PONG + OP_EOT;
+    static const std::string FRAME_RESP_LEAVE = OP_SOH + SC_RESP_LEAVE + OP_EOT;
+    static const std::string FRAME_RECN_LOBBY = OP_SOH + SC_RESP_RECN + OP_SEP + SC_IN_LOBBY + OP_EOT; // {rr,il}
+    static const std::string FRAME_IN_LOBBY   = OP_SOH + SC_IN_LOBBY + OP_EOT;
+    static const std::string FRAME_MV_VALID   = OP_SOH + SC_MV_VALID + OP_EOT;
+    static const std::string FRAME_GO_WIN     = OP_SOH + SC_GO_WIN + OP_EOT;
+    static const std::string FRAME_GO_LOSS    = OP_SOH + SC_GO_LOSS + OP_EOT;
+    static const std::string FRAME_OPN_LEAVE  = OP_SOH + SC_OPN_LEAVE + OP_EOT;
+    static const std::string FRAME_OPN_LOST   = OP_SOH + SC_OPN_LOST + OP_EOT;
+    static const std::string FRAME_OPN_DISC   = OP_SOH + SC_OPN_DISC + OP_EOT;
+    static const std::string FRAME_OPN_RECN   = OP_SOH + SC_OPN_RECN + OP_EOT;
+    static const std::string FRAME_OPN_GONE   = OP_SOH + SC_OPN_GONE + OP_EOT;
+    static const std::string FRAME_MANY_CLNT  = OP_SOH + SC_MANY_CLNT + OP_EOT; // sent without client instance
+    static const std::string FRAME_NICK_USED  = OP_SOH + SC_NICK_USED + OP_EOT;
+    static const std::string FRAME_SESS_GONE  = OP_SOH + SC_SESS_GONE + OP_EOT;
+    static const std::string FRAME_KICK       = OP_SOH + SC_KICK + OP_EOT;
+    static const std::string FRAME_SHDW       = OP_SOH + SC_SHDW + OP_EOT;
 
-    // server regex -- valid data:      <|>|c:\w{3,20}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100}    ..in curly brackets
-    static const std::regex rgx_data(R"(<|>|c:\w{3,20}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100})");
+    // note: 'a-zA-Z0-9' instead of '\w' to prevent diacritics
+    // server -- valid format (parsed by parseMsg() in packet_handler.hpp):
+    //                                          (?:\{(?:<|>|c:\w{3,20}|cb:\w{3,20}|rs:[0-9a-f]{16}|rb:[0-9a-f]{16}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100})\})+
+    // server -- valid data:            <|>|c:\w{3,20}|cb:\w{3,20}|rs:[0-9a-f]{16}|rb:[0-9a-f]{16}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100}    ..in curly brackets
+
+    // lengths of values
+    constexpr static const int NICK_MIN = 3;
+    constexpr static const int NICK_MAX = 20;
+    constexpr static const int MOVE_LEN = 8;
+    constexpr static const int TOKEN_LEN = 16;
+    constexpr static const int CHAT_MAX = 100;
+    // longest reply (reconnection to game with playfield is about 160 bytes)
+    constexpr static const int LONGEST_REPLY = 256;
+
+    // client regex -- valid format:         (?:\{(?:<|>|rc:[0-9a-f]{16}|rr,il|rr,ig,(?:ty|to),on:\w{3,20},pf:\d{121}|rl|il|ig,(?:ty|to),on:\w{3,20}|mv|gw|gl|om:\d{8}|ol|os|od|or|og|t|u|sg|k|s|ch:[a-zA-Z0-9\s.!?]{1,100})\})+
+    // client regex -- valid data in curly brackets: <|>|rc:[0-9a-f]{16}|rr,il|rr,ig,(?:ty|to),on:\w{3,20},pf:\d{121}|rl|il|ig,(?:ty|to),on:\w{3,20}|mv|gw|gl|om:\d{8}|ol|os|od|or|og|t|u|sg|k|s|ch:[a-zA-Z0-9\s.!?]{1,100}
+}
 
-    // server regex -- valid keys and values in subdata: [^:]+
-    static const std::regex rgx_key_value(R"([^:]+)");
 
-    // client regex -- valid format:         (?:\{(?:<|>|rc|rr,il|rr,ig,(?:ty|to),on:\w{3,20},pf:\d{121}|rl|il|ig,(?:ty|to),on:\w{3,20}|mv|gw|gl|om:\d{8}|ol|os|od|or|og|t|u|k|s|ch:[a-zA-Z0-9\s.!?]{1,100})\})+
-    // client regex -- valid data in curly brackets: <|>|rc|rr,il|rr,ig,(?:ty|to),on:\w{3,20},pf:\d{121}|rl|il|ig,(?:ty|to),on:\w{3,20}|mv|gw|gl|om:\d{8}|ol|os|od|or|og|t|u|k|s|ch:[a-zA-Z0-9\s.!?]{1,100}
-}
+/******************************************************************************
+ *
+ * 	Binary protocol, which client chooses by connecting with {cb:nick}
+ * 	instead of {c:nick} (or by resuming with {rb:token}). Reply to the request
+ * 	is already binary. Message is [opcode][length of payload as varint][payload].
+ * 	Payload is nick, session token or chat text, move packed to 2 bytes
+ * 	(square y * 11 + x, from and to) or reconnection to game ([nick length]
+ * 	[nick][playfield by 3 bits]).
+ *
+ */
+enum BinaryOpcode : unsigned char {
+    // both directions
+    B_Ping              = 0x01,
+    B_Pong              = 0x02,
+    B_Chat              = 0x03,
+    // client -> server
+    B_Conn              = 0x10,
+    B_Ready             = 0x11,
+    B_Move              = 0x12,
+    B_Leave             = 0x13,
+    B_Ok                = 0x14,
+    B_Resume            = 0x15,
+    // server -> client
+    B_RespConn          = 0x20,
+    B_RespLeave         = 0x21,
+    B_RecnLobby         = 0x22,
+    B_InLobby           = 0x23,
+    B_MoveValid         = 0x24,
+    B_GameWin           = 0x25,
+    B_GameLoss          = 0x26,
+    B_OpnLeave          = 0x27,
+    B_OpnLost           = 0x28,
+    B_OpnDisc           = 0x29,
+    B_OpnRecn           = 0x2a,
+    B_OpnGone           = 0x2b,
+    B_NickUsed          = 0x2c,
+    B_Kick              = 0x2d,
+    B_Shutdown          = 0x2e,
+    B_SessGone          = 0x2f,
+    B_InGameOnTurn      = 0x30,
+    B_InGameOnStand     = 0x31,
+    B_RecnGameOnTurn    = 0x32,
+    B_RecnGameOnStand   = 0x33,
+    B_OpnMove           = 0x34
+};
 
 
 #endif
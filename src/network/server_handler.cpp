@@ -1,12 +1,25 @@
+#include <pthread.h>
+// getrlimit(), setrlimit()
+#include <sys/resource.h>
+
 #include <cstring>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "../system/defaults.hpp"
 #include "../system/Logger.hpp"
 #include "../system/signal.hpp"
+#include "frame_scan.hpp"
 #include "Server.hpp"
 
 
+/** Descriptors of one shard besides clients (server socket, reactor, timerfd, eventfd). */
+constexpr const int FILES_PER_SHARD = 8;
+/** Descriptors of whole process (standard streams, log file, ...). */
+constexpr const int FILES_SLACK = 32;
+
+
 /******************************************************************************
  *
  * 	Tells server to stop running on CTRL+C.
@@ -20,20 +33,65 @@ void signalHandler(int signum) {
 
 /******************************************************************************
  *
- * Creates server instance as unique pointer.
- * Exits with error value in 'catch', if instance was not created.
+ * Raises soft limit of open files, so every client gets its socket. Every shard
+ * needs some more descriptors (server socket, reactor, timerfd, eventfd),
+ * as well as the logger. Soft limit is never lowered and never goes above
+ * hard limit, which only privileged process could raise.
+ *
+ */
+void server_raise_files(const Defaults& defs) {
+    struct rlimit files{};
+    rlim_t wanted = (rlim_t) defs.def_clients + FILES_PER_SHARD * defs.def_threads + FILES_SLACK;
+
+    if (getrlimit(RLIMIT_NOFILE, &files) != 0) {
+        logger->warning("Unable to get limit of open files [%s].", std::strerror(errno));
+        return;
+    }
+
+    if (files.rlim_max != RLIM_INFINITY && files.rlim_max < wanted) {
+        logger->warning("Hard limit of open files [%lu] is lower than needed [%lu], not every client may connect.",
+                        (unsigned long) files.rlim_max, (unsigned long) wanted);
+        wanted = files.rlim_max;
+    }
+
+    if (files.rlim_cur < wanted) {
+        files.rlim_cur = wanted;
+
+        if (setrlimit(RLIMIT_NOFILE, &files) != 0) {
+            logger->warning("Unable to raise limit of open files [%s].", std::strerror(errno));
+        }
+    }
+
+    getrlimit(RLIMIT_NOFILE, &files);
+    logger->info("open files limit: [%lu]", (unsigned long) files.rlim_cur);
+}
+
+
+/******************************************************************************
+ *
+ * Creates server instance for every shard as unique pointer. Limits of clients
+ * and rooms are divided among shards.
+ * Exits with error value in 'catch', if some instance was not created.
  *
- * @return Moves unique pointer.
+ * @return Moves vector of unique pointers.
  *
  */
-std::unique_ptr<Server> server_init(const Defaults& defs) {
-    std::unique_ptr<Server> server = nullptr;
+std::vector<std::unique_ptr<Server>> server_init(const Defaults& defs, Shards& shards) {
+    std::vector<std::unique_ptr<Server>> servers;
+
+    int count = shards.getCount();
+    int clients = (defs.def_clients + count - 1) / count;
+    int rooms = (defs.def_rooms + count - 1) / count;
 
     logger->info("Initializing server.");
 
     try {
-        // create server instance
-        server = std::make_unique<Server>(defs.def_addr, defs.def_port, defs.def_clients, defs.def_rooms);
+        // create server instance of every shard
+        for (int id = 0; id < count; ++id) {
+            servers.push_back(std::make_unique<Server>(defs.def_addr, defs.def_port, clients, rooms, defs.def_backend,
+                                                       defs.def_outlimit * 1024, defs.def_backlog,
+                                                       strcmp(defs.def_match, "rated") == 0, &shards, id));
+        }
     }
     catch (const std::exception& ex) {
         // if server was not created, print exception and exit
@@ -42,12 +100,18 @@ std::unique_ptr<Server> server_init(const Defaults& defs) {
     }
 
     logger->info("Server initialized.");
-    logger->info("IP address: [%s]",      server->getIPaddress());
-    logger->info("port: [%d]",            server->getPort());
-    logger->info("max. clients: [%d]",    server->getMaxClients());
-    logger->info("max. game rooms: [%d]", server->getMaxRooms());
-
-    return std::move(server);
+    logger->info("IP address: [%s]",      servers[0]->getIPaddress());
+    logger->info("port: [%d]",            servers[0]->getPort());
+    logger->info("shards: [%d]",          count);
+    logger->info("max. clients: [%d] per shard",    servers[0]->getMaxClients());
+    logger->info("max. game rooms: [%d] per shard", servers[0]->getMaxRooms());
+    logger->info("event loop: [%s]",      servers[0]->getBackend());
+    logger->info("frame scan: [%s]",      getScanKernel());
+    logger->info("output limit: [%d] KB per client", defs.def_outlimit);
+    logger->info("backlog: [%d] per shard", defs.def_backlog);
+    logger->info("matchmaking: [%s]", defs.def_match);
+
+    return servers;
 }
 
 
@@ -58,38 +122,80 @@ std::unique_ptr<Server> server_init(const Defaults& defs) {
  * @param server Server instance.
  *
  */
-void server_run(std::unique_ptr<Server> server) {
-    logger->info("Running server.");
-
+void server_run_shard(Server* server) {
     try {
         // run server
         server->run();
     }
     catch (const std::exception& ex) {
         // if server crashed, log exception and exit
-        logger->fatal("Server crashed [%s, %s].", ex.what(), std::strerror(errno));
+        logger->fatal("Server shard [%d] crashed [%s, %s].", server->getShardId(), ex.what(), std::strerror(errno));
         exit(EXIT_FAILURE);
     }
+}
+
+
+/******************************************************************************
+ *
+ * Runs every shard in its own thread, first one in this thread.
+ * Other threads block SIGINT, so the signal always releases first shard,
+ * which then wakes the others.
+ *
+ */
+void server_run(std::vector<std::unique_ptr<Server>> servers, Shards& shards) {
+    std::vector<std::thread> threads;
+    sigset_t sigint;
+
+    logger->info("Running server.");
+
+    sigemptyset(&sigint);
+    sigaddset(&sigint, SIGINT);
+
+    // new threads inherit blocked signal
+    pthread_sigmask(SIG_BLOCK, &sigint, nullptr);
+
+    for (std::size_t i = 1; i < servers.size(); ++i) {
+        threads.emplace_back(server_run_shard, servers[i].get());
+    }
+
+    pthread_sigmask(SIG_UNBLOCK, &sigint, nullptr);
+
+    server_run_shard(servers[0].get());
+
+    // first shard stopped, so stop the others
+    shards.wakeAll();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
     logger->info("Server stopped successfully.");
 
     // print statistics after successful shutdown
-    server->prStats();
+    for (auto& server : servers) {
+        server->prStats();
+    }
 }
 
 
 /******************************************************************************
  *
- * Calls a function, that creates server instance.
- * Then calls a function, that runs the instance.
+ * Calls a function, that creates server instances.
+ * Then calls a function, that runs the instances.
  *
  */
 void server_setup(Defaults& defs) {
     // register signal SIGINT with signal handler function
     std::signal(SIGINT, signalHandler);
 
-    // create server instance
-    auto server = server_init(defs);
-    // run the server
-    server_run(std::move(server));
+    // every client needs its socket
+    server_raise_files(defs);
+
+    // shared context of reactor threads
+    Shards shards(defs.def_threads);
+
+    // create server instances
+    auto servers = server_init(defs, shards);
+    // run the servers
+    server_run(std::move(servers), shards);
 }
@@ -77,6 +77,9 @@ void Logger::setLevel(const Level lvl) {
 void Logger::log(const char* severity, const char* buff) {
     std::stringstream out;
     out << severity << getDateTime() << buff << std::endl;
+
+    const std::lock_guard<std::mutex> lock(this->mtx);
+
     this->file << out.str();
     std::cout << out.str();
 
@@ -2,6 +2,7 @@
 #define LOGGER_HPP
 
 #include <fstream>
+#include <mutex>
 
 enum Level {
     Off     = 0,
@@ -36,6 +37,9 @@ private:
     /** Level of logger severity. */
     Level level;
 
+    /** Mutex for logging from more threads (shards). */
+    std::mutex mtx;
+
     /** Prevent construction. */
     Logger();
     /** Prevent unwanted destruction. */
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <regex>
 
+#include "../network/Reactor.hpp"
 #include "defaults.hpp"
 
 
@@ -53,6 +54,38 @@ void handle_flag_string(const char* str, char* attribute, int& rv) {
 }
 
 
+/******************************************************************************
+ *
+ * 	Handles name of event loop backend.
+ *
+ */
+void handle_flag_backend(const char* str, char* attribute, int& rv) {
+    if (Reactor::isBackend(str)) {
+        strcpy(attribute, str);
+    }
+    else {
+        std::cout << "Invalid argument: " << str << std::endl;
+        rv = -1;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * 	Handles name of matchmaking.
+ *
+ */
+void handle_flag_match(const char* str, char* attribute, int& rv) {
+    if (strcmp(str, "fifo") == 0 || strcmp(str, "rated") == 0) {
+        strcpy(attribute, str);
+    }
+    else {
+        std::cout << "Invalid argument: " << str << std::endl;
+        rv = -1;
+    }
+}
+
+
 /******************************************************************************
  *
  * 	Handles int value of parsed flag.
@@ -105,12 +138,37 @@ int parse_arguments(const int& argc, char const **argv, Defaults& defs) {
 
                         case 'c':
                             // valid client count number
-                            handle_flag_int(argv[i+1], defs.def_clients, 2, 20, rv);
+                            handle_flag_int(argv[i+1], defs.def_clients, 2, 100000, rv);
                             break;
 
                         case 'r':
                             // valid game rooms number
-                            handle_flag_int(argv[i+1], defs.def_rooms, 1, 10, rv);
+                            handle_flag_int(argv[i+1], defs.def_rooms, 1, 50000, rv);
+                            break;
+
+                        case 'e':
+                            // valid event loop backend
+                            handle_flag_backend(argv[i+1], defs.def_backend, rv);
+                            break;
+
+                        case 't':
+                            // valid count of reactor threads
+                            handle_flag_int(argv[i+1], defs.def_threads, 1, 64, rv);
+                            break;
+
+                        case 'o':
+                            // valid limit of client's output
+                            handle_flag_int(argv[i+1], defs.def_outlimit, 1, 1024, rv);
+                            break;
+
+                        case 'b':
+                            // valid size of queue for new connections
+                            handle_flag_int(argv[i+1], defs.def_backlog, 1, 65535, rv);
+                            break;
+
+                        case 'm':
+                            // valid matchmaking
+                            handle_flag_match(argv[i+1], defs.def_match, rv);
                             break;
 
                         default:
@@ -11,6 +11,16 @@ struct Defaults {
     int def_clients;
     // default count of game rooms
     int def_rooms;
+    // default event loop backend
+    char def_backend[8];
+    // default count of reactor threads (shards)
+    int def_threads;
+    // default limit of queued output of one client (KB)
+    int def_outlimit;
+    // default size of queue for new connections
+    int def_backlog;
+    // default matchmaking (fifo or rated)
+    char def_match[8];
 };
 
 
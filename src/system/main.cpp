@@ -22,9 +22,19 @@ void pr_help() {
     "  -p    Port                           default: 4567\n"
     "                                       range: <1024;49151>\n"
     "  -c    Max count of connected clients default: 10\n"
-    "                                       range: <2;20>\n"
+    "                                       range: <2;100000>\n"
     "  -r    Max count of game rooms        default: 5\n"
-    "                                       range: <1;10>\n\n"
+    "                                       range: <1;50000>\n"
+    "  -e    Event loop backend             default: epoll\n"
+    "                                       values: epoll, select, uring\n"
+    "  -t    Count of reactor threads       default: 1\n"
+    "                                       range: <1;64>\n"
+    "  -o    Output limit per client (KB)   default: 64\n"
+    "                                       range: <1;1024>\n"
+    "  -b    Backlog of new connections     default: 128\n"
+    "                                       range: <1;65535>\n"
+    "  -m    Matchmaking                    default: fifo\n"
+    "                                       values: fifo, rated\n\n"
     "Created by matenestor for KIV/UPS. Skål!\n"
     << std::endl;
 }
@@ -40,7 +50,7 @@ int main(int argc, char const **argv) {
     logger->setLevel(Debug);
 
     // default server parameters
-    Defaults defs{"0.0.0.0", 4567, 10, 5};
+    Defaults defs{"0.0.0.0", 4567, 10, 5, "epoll", 1, 64, 128, "fifo"};
 
     // parse terminal arguments
     int rv = parse_arguments(argc, argv, defs);
@@ -0,0 +1,330 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_codec.hpp"
+#include "RingBuffer.hpp"
+#include "protocol.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Test of binary protocol -- decoding of client's messages to text frames,
+ * 	encoding of replies and refusing of invalid messages, for which Server
+ * 	kicks the client (see Server::takeRequests()).
+ *
+ * 		test_binary_codec    exit 1, when some message is transcoded wrong
+ *
+ */
+
+
+/** Size of side of playfield, square is y * SIZE + x. */
+constexpr const int PF_SIZE = 11;
+/** Bits of one square of packed playfield. */
+constexpr const int PF_BITS = 3;
+
+/** Binary message and text frames, which it decodes to (empty, when it is invalid). */
+struct Decoded {
+    const char* name;
+    std::string msg;
+    std::string frames;
+};
+
+/** Text frame of reply and binary message, which it encodes to (empty, when it has no binary form). */
+struct Encoded {
+    const char* name;
+    std::string frame;
+    std::string msg;
+};
+
+
+static std::string bytes(std::initializer_list<int> values) {
+    std::string out;
+
+    for (const int& value : values) {
+        out += (char) value;
+    }
+
+    return out;
+}
+
+
+static std::string repeat(const char& c, const int& count) {
+    return std::string(count, c);
+}
+
+
+static const std::string TOKEN = "0123456789abcdef";
+/** Squares of move "07050710" -- x 7 y 5 and x 7 y 10. */
+static const std::string MOVE = bytes({5 * PF_SIZE + 7, 10 * PF_SIZE + 7});
+
+static const std::vector<Decoded> DECODED = {
+    {"ping",                    bytes({B_Ping, 0}),                                 "{>}"},
+    {"pong",                    bytes({B_Pong, 0}),                                 "{<}"},
+    {"ready",                   bytes({B_Ready, 0}),                                "{rd}"},
+    {"leave",                   bytes({B_Leave, 0}),                                "{l}"},
+    {"ok",                      bytes({B_Ok, 0}),                                   "{ok}"},
+    {"connect",                 bytes({B_Conn, 3}) + "abc",                         "{c:abc}"},
+    {"connect nick 20",         bytes({B_Conn, 20}) + repeat('a', 20),              "{c:" + repeat('a', 20) + "}"},
+    {"resume",                  bytes({B_Resume, 16}) + TOKEN,                      "{rs:" + TOKEN + "}"},
+    {"chat 1",                  bytes({B_Chat, 1}) + "x",                           "{ch:x}"},
+    {"chat 100",                bytes({B_Chat, 100}) + repeat('x', 100),            "{ch:" + repeat('x', 100) + "}"},
+    {"move",                    bytes({B_Move, 2}) + MOVE,                          "{m:07050710}"},
+    {"move corners",            bytes({B_Move, 2, 0, 120}),                         "{m:00001010}"},
+    {"more messages",           bytes({B_Conn, 3}) + "abc" + bytes({B_Ready, 0, B_Move, 2}) + MOVE,
+                                                                                    "{c:abc}{rd}{m:07050710}"},
+    {"non-minimal varint",      bytes({B_Ready, 0x80, 0x00}),                       "{rd}"},
+
+    {"nick 2",                  bytes({B_Conn, 2}) + "ab",                          ""},
+    {"nick 21",                 bytes({B_Conn, 21}) + repeat('a', 21),              ""},
+    {"nick character",          bytes({B_Conn, 3}) + "a}b",                         ""},
+    {"token character",         bytes({B_Resume, 16}) + "0123456789ABCDEF",         ""},
+    {"chat 0",                  bytes({B_Chat, 0}),                                 ""},
+    {"chat 101",                bytes({B_Chat, 101}) + repeat('x', 101),            ""},
+    {"chat character",          bytes({B_Chat, 3}) + "a{b",                         ""},
+    {"square 121",              bytes({B_Move, 2, 0, 121}),                         ""},
+    {"square 255",              bytes({B_Move, 2, 255, 0}),                         ""},
+    {"move of 1 byte",          bytes({B_Move, 1, 0}),                              ""},
+    {"move of 3 bytes",         bytes({B_Move, 3, 0, 1, 2}),                        ""},
+    {"payload of ready",        bytes({B_Ready, 1}) + "x",                          ""},
+    {"opcode 0",                bytes({0, 0}),                                      ""},
+    {"opcode of reply",         bytes({B_InLobby, 0}),                              ""},
+    {"bad opcode after valid",  bytes({B_Ready, 0, 0x7f, 0}),                       ""},
+    {"truncated varint",        bytes({B_Chat, 0x80}),                              ""},
+    {"missing varint",          bytes({B_Ready}),                                   ""},
+    {"varint of 3 bytes",       bytes({B_Chat, 0x80, 0x80, 0x01}),                  ""},
+    {"length over message",     bytes({B_Chat, 5}) + "abc",                         ""},
+};
+
+static const std::vector<Encoded> ENCODED = {
+    {"ping",                    Protocol::FRAME_PING,                               bytes({B_Ping, 0})},
+    {"kick",                    Protocol::FRAME_KICK,                               bytes({B_Kick, 0})},
+    {"in lobby",                Protocol::FRAME_IN_LOBBY,                           bytes({B_InLobby, 0})},
+    {"reconnect to lobby",      Protocol::FRAME_RECN_LOBBY,                         bytes({B_RecnLobby, 0})},
+    {"connect response",        "{rc:" + TOKEN + "}",                               bytes({B_RespConn, 16}) + TOKEN},
+    {"in game on turn",         "{ig,ty,on:bobby}",                                 bytes({B_InGameOnTurn, 5}) + "bobby"},
+    {"in game on stand",        "{ig,to,on:bobby}",                                 bytes({B_InGameOnStand, 5}) + "bobby"},
+    {"opponent's move",         "{om:07050710}",                                    bytes({B_OpnMove, 2}) + MOVE},
+    {"chat 100",                "{ch:" + repeat('x', 100) + "}",                    bytes({B_Chat, 100}) + repeat('x', 100)},
+    {"chat with 2-byte varint", "{ch:" + repeat('x', 200) + "}",                    bytes({B_Chat, 0xc8, 0x01}) + repeat('x', 200)},
+    {"unknown frame",           "{zz}",                                             ""},
+    {"ping with value",         "{>:1}",                                            ""},
+};
+
+
+static std::string hex(const std::string& msg) {
+    std::string out;
+    char digits[4];
+
+    for (const char& c : msg) {
+        std::snprintf(digits, sizeof(digits), "%02x ", (unsigned char) c);
+        out += digits;
+    }
+
+    return out;
+}
+
+
+static bool checkDecoded(const Decoded& test) {
+    std::string frames;
+    int decoded = decodeMessages(test.msg, frames);
+    bool valid = !test.frames.empty();
+
+    if ((decoded == 0) != valid || (valid && frames != test.frames)) {
+        std::printf("FAIL: decoding [%s] %s gives %d [%s]\n", test.name, hex(test.msg).c_str(), decoded, frames.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool checkEncoded(const Encoded& test) {
+    std::string msg(test.frame.length(), '\0');
+
+    msg.resize(encodeFrame(test.frame, &msg[0]));
+
+    if (msg != test.msg) {
+        std::printf("FAIL: encoding [%s] gives %s\n", test.name, hex(msg).c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+/******************************************************************************
+ *
+ * 	Varint of 1 and 2 bytes is read back, longer one is refused
+ * 	and shorter header than varint says is not complete.
+ *
+ */
+static bool checkVarint() {
+    const int lengths[] = {0, 1, 127, 128, 200, 16383};
+    bool same = true;
+    int payload = 0;
+
+    for (const int& length : lengths) {
+        std::string frame = "{ch:" + repeat('x', length) + "}";
+        std::string msg(frame.length(), '\0');
+        int header = 0;
+
+        msg.resize(encodeFrame(frame, &msg[0]));
+        header = headerLength(msg.data(), msg.length(), payload);
+
+        if (header != (length < 128 ? 2 : 3) || payload != length || (int) msg.length() != header + length) {
+            std::printf("FAIL: varint of length %d gives header %d and payload %d\n", length, header, payload);
+            same = false;
+        }
+
+        // every shorter part of header waits for the rest
+        for (int available = 0; available < header; ++available) {
+            if (headerLength(msg.data(), available, payload) != 0) {
+                std::printf("FAIL: header of length %d is complete with %d bytes\n", length, available);
+                same = false;
+            }
+        }
+    }
+
+    if (headerLength(bytes({B_Chat, 0xff, 0xff, 0x01}).data(), 4, payload) != -1) {
+        std::printf("FAIL: varint of 3 bytes is not refused\n");
+        same = false;
+    }
+
+    return same;
+}
+
+
+/******************************************************************************
+ *
+ * 	Playfield of reconnection is packed by 3 bits per square, the lowest
+ * 	bits first -- unpacked here the way client does it.
+ *
+ */
+static bool checkPlayfield() {
+    std::string pf;
+    std::string frame;
+    std::string msg;
+    std::string nick = "bobby";
+    int packed = (PF_SIZE * PF_SIZE * PF_BITS + 7) / 8;
+    int header = 0;
+    int payload = 0;
+
+    for (int i = 0; i < PF_SIZE * PF_SIZE; ++i) {
+        pf += (char) ('0' + (i * 5 + i / 6) % 6);
+    }
+
+    frame = "{rr,ig,to,on:" + nick + ",pf:" + pf + "}";
+    msg = std::string(frame.length(), '\0');
+    msg.resize(encodeFrame(frame, &msg[0]));
+    header = headerLength(msg.data(), msg.length(), payload);
+
+    if (msg.empty() || (unsigned char) msg[0] != B_RecnGameOnStand || header <= 0
+            || payload != 1 + (int) nick.length() + packed || (int) msg.length() != header + payload
+            || msg[header] != (char) nick.length() || msg.compare(header + 1, nick.length(), nick) != 0) {
+        std::printf("FAIL: reconnection to game gives %s\n", hex(msg).c_str());
+        return false;
+    }
+
+    const char* squares = &msg[header + 1 + nick.length()];
+    std::string unpacked;
+
+    for (int bit = 0; bit < PF_SIZE * PF_SIZE * PF_BITS; bit += PF_BITS) {
+        int twoBytes = (unsigned char) squares[bit / 8];
+
+        if (bit / 8 + 1 < packed) {
+            twoBytes |= (unsigned char) squares[bit / 8 + 1] << 8;
+        }
+
+        unpacked += (char) ('0' + ((twoBytes >> (bit % 8)) & 7));
+    }
+
+    if (unpacked != pf) {
+        std::printf("FAIL: playfield\n  %s\nunpacked as\n  %s\n", pf.c_str(), unpacked.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+/******************************************************************************
+ *
+ * 	Messages go through receive ring like in Server::takeRequests(),
+ * 	client is kicked, when decoding of taken messages fails.
+ *
+ */
+static bool isKicked(RingBuffer& ring, const std::string& received, std::string& frames) {
+    std::string messages;
+
+    frames.clear();
+    ring.write(received.data(), received.length());
+    ring.takeMessages(messages);
+
+    return decodeMessages(messages, frames) != 0;
+}
+
+
+static bool checkKick() {
+    bool same = true;
+    std::string frames;
+
+    {
+        RingBuffer ring;
+
+        // unfinished message waits for the rest, complete one is served
+        if (isKicked(ring, bytes({B_Conn, 3}) + "a", frames) || !frames.empty()
+                || isKicked(ring, "bc", frames) || frames != "{c:abc}") {
+            std::printf("FAIL: message received in parts\n");
+            same = false;
+        }
+    }
+    {
+        RingBuffer ring;
+
+        // length over the longest valid message is not waited for
+        if (!isKicked(ring, bytes({B_Chat, 0xff, 0x01}) + "xx", frames)) {
+            std::printf("FAIL: over-long length of message does not kick\n");
+            same = false;
+        }
+    }
+    {
+        RingBuffer ring;
+
+        if (!isKicked(ring, bytes({B_Ready, 0, 0x7f, 0}), frames)) {
+            std::printf("FAIL: bad opcode does not kick\n");
+            same = false;
+        }
+    }
+    {
+        RingBuffer ring;
+
+        if (!isKicked(ring, bytes({B_Move, 2, 0, 121}), frames)) {
+            std::printf("FAIL: square over playfield does not kick\n");
+            same = false;
+        }
+    }
+
+    return same;
+}
+
+
+int main() {
+    bool same = true;
+
+    for (const auto& test : DECODED) {
+        same &= checkDecoded(test);
+    }
+
+    for (const auto& test : ENCODED) {
+        same &= checkEncoded(test);
+    }
+
+    same &= checkVarint();
+    same &= checkPlayfield();
+    same &= checkKick();
+
+    std::printf("%zu decoded and %zu encoded messages %s\n", DECODED.size(), ENCODED.size(), same ? "OK" : "FAILED");
+
+    return same ? 0 : 1;
+}
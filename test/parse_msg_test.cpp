@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "packet_handler.hpp"
+
+
+/******************************************************************************
+ *
+ * 	Test of parseMsg() -- table of accepted and refused messages and check
+ * 	against regular expression of protocol, which parseMsg() replaced.
+ *
+ * 		test_parse_msg    exit 1, when some message is parsed wrong
+ *
+ */
+
+
+/** Messages made up of random pieces, which are compared with regular expression. */
+constexpr const int RANDOM = 200000;
+/** Most of pieces of one random message. */
+constexpr const int PIECES = 12;
+
+/** Regular expression of valid message (the former one, with keys added since). */
+static const std::regex VALID_FORMAT(
+        R"((?:\{(?:<|>|c:\w{3,20}|cb:\w{3,20}|rs:[0-9a-f]{16}|rb:[0-9a-f]{16}|rd|m:\d{8}|l|ok|ch:[a-zA-Z0-9\s.!?]{1,100})\})+)");
+
+/** Message and whether it is valid. */
+struct Case {
+    std::string msg;
+    bool valid;
+};
+
+
+static std::string repeat(const char& c, const int& count) {
+    return std::string(count, c);
+}
+
+
+static const std::vector<Case> CASES = {
+    // requests without value
+    {"{>}",                                         true},
+    {"{<}",                                         true},
+    {"{rd}",                                        true},
+    {"{l}",                                         true},
+    {"{ok}",                                        true},
+    {"{rd:}",                                       false},
+    {"{rd:1}",                                      false},
+    {"{x}",                                         false},
+    {"{}",                                          false},
+
+    // nick
+    {"{c:" + repeat('a', 2) + "}",                  false},
+    {"{c:" + repeat('a', 3) + "}",                  true},
+    {"{c:" + repeat('a', 20) + "}",                 true},
+    {"{c:" + repeat('a', 21) + "}",                 false},
+    {"{c:Nick_09}",                                 true},
+    {"{cb:abc}",                                    true},
+    {"{cb:ab}",                                     false},
+    {"{c:ni-ck}",                                   false},
+    {"{c:ni ck}",                                   false},
+    {"{c:}",                                        false},
+    {"{c}",                                         false},
+
+    // move
+    {"{m:07050710}",                                true},
+    {"{m:00000000}",                                true},
+    {"{m:0705071}",                                 false},
+    {"{m:070507100}",                               false},
+    {"{m:0705071a}",                                false},
+    {"{m:}",                                        false},
+
+    // token
+    {"{rs:0123456789abcdef}",                       true},
+    {"{rb:0123456789abcdef}",                       true},
+    {"{rs:0123456789ABCDEF}",                       false},
+    {"{rs:0123456789abcde}",                        false},
+    {"{rs:0123456789abcdef0}",                      false},
+    {"{rs:0123456789abcdeg}",                       false},
+
+    // chat
+    {"{ch:x}",                                      true},
+    {"{ch:" + repeat('x', 100) + "}",               true},
+    {"{ch:" + repeat('x', 101) + "}",               false},
+    {"{ch:}",                                       false},
+    {"{ch:Hi there. Ok!? 42\t}",                    true},
+    {"{ch:a,b}",                                    false},
+    {"{ch:a:b}",                                    false},
+    {"{ch:a{b}",                                    false},
+    {"{ch:a}b}",                                    false},
+
+    // more requests and framing
+    {"{c:abc}{rd}{m:01020304}{ch:gg}",              true},
+    {"{rd}{c:ab}",                                  false},
+    {"{rd}{",                                       false},
+    {"{rd}x",                                       false},
+    {"x{rd}",                                       false},
+    {"{{rd}}",                                      false},
+    {"{rd",                                         false},
+    {"rd}",                                         false},
+    {"{ rd}",                                       false},
+    {"",                                            false},
+};
+
+/** Pieces of random messages -- parts of valid ones and characters around them. */
+static const std::vector<std::string> PIECES_OF = {
+    "{", "}", ":", ",", "{c:", "{cb:", "{rs:", "{rb:", "{m:", "{ch:", "{rd}", "{l}", "{ok}", "{>}", "{<}",
+    "c", "m", "l", "rd", "ch", "ok", "0", "7", "01020304", "0123456789abcdef", "abc", "Abc_1", "xyz",
+    "A", "F", "g", "_", " ", "\t", ".", "!", "?", "-", "#", "\x7f", "\xc3\xa1",
+    repeat('a', 17), repeat('x', 50), repeat('x', 97),
+};
+
+
+/******************************************************************************
+ *
+ * 	Requests of valid message put together have to give the message back.
+ *
+ */
+static bool sameRequests(const std::string& msg, const clientData& data) {
+    std::string joined;
+
+    for (const auto& rqst : data) {
+        if (rqst.op == O_Unknown) {
+            return false;
+        }
+
+        joined += Protocol::OP_SOH;
+        joined += rqst.key;
+
+        if (!rqst.value.empty()) {
+            joined += Protocol::OP_INI;
+            joined += rqst.value;
+        }
+
+        joined += Protocol::OP_EOT;
+    }
+
+    return joined == msg;
+}
+
+
+static bool checkCase(const std::string& msg, const bool& valid) {
+    clientData data;
+    int parsed = parseMsg(msg, data);
+
+    if ((parsed == 0) != valid) {
+        std::printf("FAIL: [%s] is %s, parsed as %s\n", msg.c_str(), valid ? "valid" : "invalid", parsed == 0 ? "valid" : "invalid");
+        return false;
+    }
+
+    if (valid ? !sameRequests(msg, data) : !data.empty()) {
+        std::printf("FAIL: [%s] gives wrong requests\n", msg.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+int main() {
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> count(1, PIECES);
+    std::uniform_int_distribution<int> piece(0, PIECES_OF.size() - 1);
+    bool same = true;
+    int valid = 0;
+
+    for (const auto& test : CASES) {
+        if (std::regex_match(test.msg, VALID_FORMAT) != test.valid) {
+            std::printf("FAIL: table and regular expression differ on [%s]\n", test.msg.c_str());
+            same = false;
+        }
+
+        same &= checkCase(test.msg, test.valid);
+    }
+
+    for (int i = 0; i < RANDOM; ++i) {
+        std::string msg;
+
+        for (int j = count(random); j > 0; --j) {
+            msg += PIECES_OF[piece(random)];
+        }
+
+        bool expected = std::regex_match(msg, VALID_FORMAT);
+
+        valid += expected;
+        same &= checkCase(msg, expected);
+    }
+
+    std::printf("%zu messages of table, %d random ones (%d valid) %s\n", CASES.size(), RANDOM, valid, same ? "OK" : "FAILED");
+
+    return same ? 0 : 1;
+}